@@ -0,0 +1,231 @@
+#include "benchmark.h"
+
+#include <milpcpp/backend.h>
+
+#include<fstream>
+#include<iostream>
+#include<regex>
+#include<sstream>
+
+// Usage: benchmarks [--benchmark_filter=REGEX] [--sizes=1000,10000,...]
+//                   [--backends=none,dual_simplex,glpk,lp_solve,highs,cbc] [--max_solve_size=N]
+//                   [--repetitions=N] [--allocators=arena,heap] [--format=json|csv] [--out=FILE]
+//
+// Sizes go up to 1e7 by default; backends other than none only run sizes up
+// to --max_solve_size, 1e5 by default, so the larger ones time generation.
+
+namespace
+{
+	struct entry
+	{
+		const char * _name;
+		benchmark::function _function;
+	};
+
+	std::vector<entry>& registry()
+	{
+		static std::vector<entry> benchmarks;
+		return benchmarks;
+	}
+
+	struct result
+	{
+		std::string _name;
+		std::string _model;
+		benchmark::backend_kind _backend;
+		bool _arenas;
+		size_t _size;
+		int _repetition;
+		benchmark::state _state;
+	};
+
+	std::vector<std::string> split(const std::string& s)
+	{
+		std::vector<std::string> result;
+		std::stringstream in(s);
+		std::string item;
+		while (std::getline(in, item, ','))
+			result.push_back(item);
+		return result;
+	}
+
+	void write_json(std::ostream& out, const std::vector<result>& results)
+	{
+		out << "{\n\"context\": {\"library\": \"milpcpp\", \"time_unit\": \"s\"},\n\"benchmarks\": [";
+		const char * separator = "\n";
+		for (const auto&r : results)
+		{
+			out << separator << "{\"name\": \"" << r._name << "\""
+				<< ", \"model\": \"" << r._model << "\""
+				<< ", \"backend\": \"" << benchmark::backend_name(r._backend) << "\""
+				<< ", \"allocator\": \"" << (r._arenas ? "arena" : "heap") << "\""
+				<< ", \"size\": " << r._size
+				<< ", \"repetition\": " << r._repetition;
+			for (const auto&[name, value] : r._state.counters())
+				out << ", \"" << name << "\": " << value;
+			for (const auto&[name, value] : r._state.times())
+				out << ", \"" << name << "_time\": " << value;
+			out << "}";
+			separator = ",\n";
+		}
+		out << "\n]\n}\n";
+	}
+
+	void write_csv(std::ostream& out, const std::vector<result>& results)
+	{
+		out << "name,model,backend,allocator,size,repetition,variables,rows,nonzeros,objective,"
+			"data_time,generation_time,load_time,solve_time\n";
+		for (const auto&r : results)
+		{
+			auto value = [](const auto& values, const std::string& name) {
+				std::ostringstream result;
+				for (const auto&[n, v] : values)
+					if (n == name)
+						result << v;
+				return result.str();
+			};
+			out << r._name << ',' << r._model << ',' << benchmark::backend_name(r._backend) << ','
+				<< (r._arenas ? "arena" : "heap") << ',' << r._size << ',' << r._repetition << ','
+				<< value(r._state.counters(), "variables") << ',' << value(r._state.counters(), "rows") << ','
+				<< value(r._state.counters(), "nonzeros") << ',' << value(r._state.counters(), "objective") << ','
+				<< value(r._state.times(), "data") << ',' << value(r._state.times(), "generation") << ','
+				<< value(r._state.times(), "load") << ',' << value(r._state.times(), "solve") << '\n';
+		}
+	}
+}
+
+namespace benchmark
+{
+	const char * backend_name(backend_kind backend)
+	{
+		switch (backend)
+		{
+		case backend_kind::dual_simplex: return "dual_simplex";
+		case backend_kind::glpk: return "glpk";
+		case backend_kind::lp_solve: return "lp_solve";
+		case backend_kind::highs: return "highs";
+		case backend_kind::cbc: return "cbc";
+		default: return "none";
+		}
+	}
+
+	registration::registration(const char * name, function f)
+	{
+		registry().push_back(entry{ name, f });
+	}
+
+	void state::solve(milpcpp::model& m)
+	{
+		if (_backend == backend_kind::none)
+			return;
+		std::unique_ptr<milpcpp::backend> solver;
+		try
+		{
+			solver = milpcpp::create_backend(backend_name(_backend), &m);
+		}
+		catch (const std::invalid_argument&)
+		{
+			return;		// not built in
+		}
+		milpcpp::solve_result result = solver->solve();
+		set_time("load", result._load._wall);
+		set_time("solve", result._solve._wall);
+		set_counter("iterations", (double)result._iterations);
+		if (result.has_solution())
+			set_counter("objective", result._objective.value());
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	std::regex filter(".*");
+	std::vector<size_t> sizes{ 1000, 10000, 100000, 1000000, 10000000 };
+	size_t max_solve_size = 100000;
+	std::vector<benchmark::backend_kind> backends{ 
+		benchmark::backend_kind::none, benchmark::backend_kind::glpk, benchmark::backend_kind::lp_solve };
+	std::vector<bool> allocators{ false };
+	int repetitions = 1;
+	std::string format = "json";
+	std::string out_file;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		auto value = arg.substr(arg.find('=') + 1);
+		if (arg.rfind("--benchmark_filter=", 0) == 0)
+			filter = std::regex(value);
+		else if (arg.rfind("--sizes=", 0) == 0)
+		{
+			sizes.clear();
+			for (const auto&s : split(value))
+				sizes.push_back((size_t)std::stod(s));
+		}
+		else if (arg.rfind("--backends=", 0) == 0)
+		{
+			backends.clear();
+			for (const auto&b : split(value))
+			{
+				if (b == "dual_simplex") backends.push_back(benchmark::backend_kind::dual_simplex);
+				else if (b == "glpk") backends.push_back(benchmark::backend_kind::glpk);
+				else if (b == "lp_solve") backends.push_back(benchmark::backend_kind::lp_solve);
+				else if (b == "highs") backends.push_back(benchmark::backend_kind::highs);
+				else if (b == "cbc") backends.push_back(benchmark::backend_kind::cbc);
+				else backends.push_back(benchmark::backend_kind::none);
+			}
+		}
+		else if (arg.rfind("--max_solve_size=", 0) == 0)
+			max_solve_size = (size_t)std::stod(value);
+		else if (arg.rfind("--allocators=", 0) == 0)
+		{
+			allocators.clear();
+			for (const auto&a : split(value))
+				allocators.push_back(a != "heap");
+		}
+		else if (arg.rfind("--repetitions=", 0) == 0)
+			repetitions = std::stoi(value);
+		else if (arg.rfind("--format=", 0) == 0)
+			format = value;
+		else if (arg.rfind("--out=", 0) == 0)
+			out_file = value;
+		else
+		{
+			std::cerr << "unknown argument " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<result> results;
+	for (const auto&b : registry())
+	{
+		for (auto backend : backends)
+		{
+			for (bool arenas : allocators)
+			{
+				for (auto size : sizes)
+				{
+					std::string name = std::string(b._name) + "/" + benchmark::backend_name(backend) + "/" + 
+						(arenas ? "arena/" : "") + std::to_string(size);
+					if (!std::regex_search(name, filter) || (backend != benchmark::backend_kind::none && size > max_solve_size))
+						continue;
+					milpcpp::memory::enable_arenas(arenas);
+					for (int repetition = 0; repetition < repetitions; ++repetition)
+					{
+						benchmark::state state(size, backend);
+						b._function(state);
+						results.push_back(result{ name, b._name, backend, arenas, size, repetition, state });
+					}
+				}
+			}
+		}
+	}
+
+	std::ofstream file;
+	if (!out_file.empty())
+		file.open(out_file);
+	std::ostream& out = out_file.empty() ? std::cout : file;
+
+	if (format == "csv")
+		write_csv(out, results);
+	else
+		write_json(out, results);
+}
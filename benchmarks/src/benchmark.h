@@ -0,0 +1,73 @@
+#ifndef __MILPCPP_BENCHMARK_H__
+#define __MILPCPP_BENCHMARK_H__
+
+#include<chrono>
+#include<string>
+#include<utility>
+#include<vector>
+
+#include<milpcpp/milpcpp.h>
+#include<milpcpp/profiler.h>
+
+// A small Google Benchmark style harness. Each registered benchmark builds
+// one book model scaled to state::size() variables and times its phases.
+namespace benchmark
+{
+	enum class backend_kind { none, dual_simplex, glpk, lp_solve, highs, cbc };
+
+	const char * backend_name(backend_kind backend);
+
+	class state
+	{
+		size_t _size;
+		backend_kind _backend;
+		std::vector<std::pair<std::string, double>> _times;
+		std::vector<std::pair<std::string, double>> _counters;
+	public:
+		state(size_t size, backend_kind backend) : _size(size), _backend(backend) {}
+
+		// Requested number of variables
+		size_t size() const { return _size; }
+		backend_kind backend() const { return _backend; }
+
+		void set_time(const std::string& phase, double seconds) { _times.emplace_back(phase, seconds); }
+		void set_counter(const std::string& name, double value) { _counters.emplace_back(name, value); }
+
+		template<typename F>
+		void phase(const std::string& name, F f)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			set_time(name, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		// Records the size of the generated model
+		void count(const milpcpp::model& m)
+		{
+			set_counter("variables", (double)m.variable_count());
+			set_counter("rows", (double)m.constraint_count());
+			set_counter("nonzeros", (double)m.nonzero_count());
+		}
+
+		// Loads and solves the model with the requested backend; the profiler
+		// splits the backend time into load and solve.
+		void solve(milpcpp::model& m);
+
+		const std::vector<std::pair<std::string, double>>& times() const { return _times; }
+		const std::vector<std::pair<std::string, double>>& counters() const { return _counters; }
+	};
+
+	typedef void(*function)(state&);
+
+	struct registration
+	{
+		registration(const char * name, function f);
+	};
+}
+
+#define MILPCPP_BENCHMARK(NAME) \
+void NAME(benchmark::state&);   \
+static benchmark::registration __##NAME##_registration__(#NAME, NAME);   \
+void NAME(benchmark::state& state)
+
+#endif
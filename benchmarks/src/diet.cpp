@@ -0,0 +1,82 @@
+#include "benchmark.h"
+
+#include<random>
+
+// diet.mod (Chapter 2) scaled to state.size() foods
+
+MILPCPP_BENCHMARK(diet)
+{
+	using namespace milpcpp;
+
+	const size_t nutr_count = 10;
+	size_t food_count = std::max<size_t>(2, state.size());
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> cost_data(1, 10);
+	std::uniform_real_distribution<double> amt_data(0, 100);
+
+	model m;
+
+	MILPCPP_SET(NUTR);
+	MILPCPP_SET(FOOD);
+
+	param<FOOD> cost(greater_than(0));
+	param<FOOD> f_min(greater_equal(0));
+	param<FOOD> f_max(greater_equal([&](FOOD j) { return f_min(j); }));
+
+	param<NUTR> n_min(greater_equal(0));
+	param<NUTR> n_max(greater_equal([&](NUTR j) { return n_min(j); }));
+
+	param<NUTR, FOOD> amt(greater_equal(0));
+
+	var<FOOD> Buy(
+		greater_equal(f_min),
+		less_equal(f_max)
+	);
+
+	state.phase("data", [&] {
+		for (size_t i = 0; i < nutr_count; ++i)
+			NUTR::add("n" + std::to_string(i));
+		for (size_t j = 0; j < food_count; ++j)
+			FOOD::add("f" + std::to_string(j));
+
+		const double food_max = 100;
+		for (size_t j = 0; j < food_count; ++j)
+		{
+			std::string food = "f" + std::to_string(j);
+			f_min.add(food, 0);
+			f_max.add(food, food_max);
+			cost.add(food, cost_data(random));
+		}
+
+		// buying half of the maximum of every food satisfies every nutrient
+		for (size_t i = 0; i < nutr_count; ++i)
+		{
+			std::string nutr = "n" + std::to_string(i);
+			double total = 0;
+			for (size_t j = 0; j < food_count; ++j)
+			{
+				double value = amt_data(random);
+				total += value * food_max;
+				amt.add(nutr, "f" + std::to_string(j), value);
+			}
+			n_min.add(nutr, 0.2 * total);
+			n_max.add(nutr, 0.8 * total);
+		}
+
+		m.seal_data();
+	});
+
+	state.phase("generation", [&] {
+		minimize("Total_Cost",
+			sum([&](FOOD j) { return cost(j)*Buy(j); }
+		));
+
+		subject_to("Diet", [&](NUTR i) {
+			return n_min(i) <= sum([&](FOOD j) { return amt(i, j) * Buy(j); }) <= n_max(i);
+		});
+	});
+
+	state.count(m);
+	state.solve(m);
+}
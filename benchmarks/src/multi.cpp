@@ -0,0 +1,94 @@
+#include "benchmark.h"
+
+#include<cmath>
+#include<random>
+
+// multi.mod (Chapter 4) scaled to state.size() shipment variables
+
+MILPCPP_BENCHMARK(multi)
+{
+	using namespace milpcpp;
+
+	const size_t prod_count = 5;
+	size_t orig_count = std::max<size_t>(2, (size_t)std::sqrt(state.size() / (4.0 * prod_count)));
+	size_t dest_count = std::max<size_t>(2, state.size() / (orig_count * prod_count));
+
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> demand_data(100, 1000);
+	std::uniform_int_distribution<int> cost_data(1, 100);
+
+	model m;
+
+	MILPCPP_SET(ORIG);
+	MILPCPP_SET(DEST);
+	MILPCPP_SET(PROD);
+
+	param<ORIG, PROD>  supply(greater_than(0));
+	param<DEST, PROD>  demand(greater_equal(0));
+
+	param<ORIG, DEST>  limit(greater_than(0));
+
+	param<ORIG, DEST, PROD> cost(greater_equal(0));
+
+	var<ORIG, DEST, PROD> Trans(greater_equal(0));
+
+	state.phase("data", [&] {
+		for (size_t i = 0; i < orig_count; ++i)
+			ORIG::add("o" + std::to_string(i));
+		for (size_t j = 0; j < dest_count; ++j)
+			DEST::add("d" + std::to_string(j));
+		for (size_t p = 0; p < prod_count; ++p)
+			PROD::add("p" + std::to_string(p));
+
+		long largest = 0;
+		for (size_t p = 0; p < prod_count; ++p)
+		{
+			std::string prod = "p" + std::to_string(p);
+			long total = 0;
+			for (size_t j = 0; j < dest_count; ++j)
+			{
+				int value = demand_data(random);
+				total += value;
+				demand.add("d" + std::to_string(j), prod, value);
+			}
+
+			// supply matches demand per product so that the equality rows are feasible
+			for (size_t i = 0; i < orig_count; ++i)
+			{
+				long value = total / (long)orig_count + (i == 0 ? total % (long)orig_count : 0);
+				supply.add("o" + std::to_string(i), prod, (double)value);
+				largest = std::max(largest, value);
+			}
+		}
+
+		for (size_t i = 0; i < orig_count; ++i)
+			for (size_t j = 0; j < dest_count; ++j)
+				for (size_t p = 0; p < prod_count; ++p)
+					cost.add("o" + std::to_string(i), "d" + std::to_string(j), "p" + std::to_string(p), cost_data(random));
+
+		limit.set_default((double)(largest * prod_count));
+
+		m.seal_data();
+	});
+
+	state.phase("generation", [&] {
+		minimize("Total_Cost",
+			sum([&](ORIG i, DEST j, PROD p) { return cost(i, j, p)*Trans(i, j, p); }
+		));
+
+		subject_to("Supply", [&](ORIG i, PROD p) {
+			return sum([&](DEST j) { return Trans(i, j, p); }) == supply(i, p);
+		});
+
+		subject_to("Demand", [&](DEST j, PROD p) {
+			return sum([&](ORIG i) { return Trans(i, j, p); }) == demand(j, p);
+		});
+
+		subject_to("Multi", [&](ORIG i, DEST j) {
+			return sum([&](PROD p) { return Trans(i, j, p); }) <= limit(i, j);
+		});
+	});
+
+	state.count(m);
+	state.solve(m);
+}
@@ -0,0 +1,86 @@
+#include "benchmark.h"
+
+#include<random>
+
+// steelT.mod (Chapter 4) scaled to roughly state.size() variables:
+// Make, Inv and Sell over PROD x 1..T
+
+MILPCPP_BENCHMARK(steelT)
+{
+	using namespace milpcpp;
+
+	const long weeks = 52;
+	size_t prod_count = std::max<size_t>(1, state.size() / (3 * weeks));
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> rate_data(100, 200);
+	std::uniform_real_distribution<double> cost_data(5, 15);
+	std::uniform_real_distribution<double> revenue_data(25, 40);
+	std::uniform_real_distribution<double> market_data(2000, 6000);
+
+	model m;
+
+	MILPCPP_SET(PROD);
+	MILPCPP_TYPED_PARAM(T);
+
+	param<PROD>              rate(greater_than(0));
+	param<PROD>              inv0(greater_equal(0));
+	param<range<1, T>>       avail(greater_than(0));
+	param<PROD, range<1, T>> market(greater_than(0));
+
+	param<PROD>               prodcost(greater_than(0));
+	param<PROD>               invcost(greater_than(0));
+	param<PROD, range<1, T>>  revenue(greater_than(0));
+
+	var<PROD, range<1, T>>    Make(greater_equal(0));
+	var<PROD, range<0, T>>    Inv(greater_equal(0));
+	var<PROD, range<1, T>>    Sell(greater_equal(0), less_equal([&](PROD p, range<1, T> t) { return market(p, t); }));
+
+	state.phase("data", [&] {
+		for (size_t p = 0; p < prod_count; ++p)
+			PROD::add("p" + std::to_string(p));
+
+		T::set_value(weeks);
+
+		for (size_t p = 0; p < prod_count; ++p)
+		{
+			std::string prod = "p" + std::to_string(p);
+			rate.add(prod, rate_data(random));
+			inv0.add(prod, 0);
+			prodcost.add(prod, cost_data(random));
+			invcost.add(prod, cost_data(random) / 4);
+			for (const auto&t : range<1, T>())
+			{
+				market.add(prod, t.name(), market_data(random));
+				revenue.add(prod, t.name(), revenue_data(random));
+			}
+		}
+
+		for (const auto&t : range<1, T>())
+			avail.add(t.name(), 40.0 * prod_count);
+
+		m.seal_data();
+	});
+
+	state.phase("generation", [&] {
+		maximize("Total_Profit",
+			sum([&](PROD p, range<1, T> t) { return
+				revenue(p, t)*Sell(p, t) - prodcost(p)*Make(p, t) - invcost(p)*Inv(p, t);
+		}));
+
+		subject_to("Time", [&](range<1, T> t) {
+			return sum([&](PROD p) { return (1 / rate(p)) * Make(p, t); }) <= avail(t);
+		});
+
+		subject_to("Init_Inv", [&](PROD p) {
+			return Inv(p, 0) == inv0(p);
+		});
+
+		subject_to("Balance", [&](PROD p, range<1, T> t) {
+			return Make(p, t) + Inv(p, t - 1) == Sell(p, t) + Inv(p, t);
+		});
+	});
+
+	state.count(m);
+	state.solve(m);
+}
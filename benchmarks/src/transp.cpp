@@ -0,0 +1,75 @@
+#include "benchmark.h"
+
+#include<cmath>
+#include<random>
+
+// transp.mod (Chapter 3) scaled to state.size() shipment variables
+
+MILPCPP_BENCHMARK(transp)
+{
+	using namespace milpcpp;
+
+	size_t orig_count = std::max<size_t>(2, (size_t)std::sqrt(state.size() / 4.0));
+	size_t dest_count = std::max<size_t>(2, state.size() / orig_count);
+
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> demand_data(100, 1000);
+	std::uniform_int_distribution<int> cost_data(1, 100);
+
+	model m;
+
+	MILPCPP_SET(ORIG);
+	MILPCPP_SET(DEST);
+
+	param<ORIG> supply(greater_than(0));
+	param<DEST> demand(greater_equal(0));
+
+	param<ORIG, DEST> cost(greater_equal(0));
+
+	var<ORIG, DEST> Trans(greater_equal(0));
+
+	state.phase("data", [&] {
+		for (size_t i = 0; i < orig_count; ++i)
+			ORIG::add("o" + std::to_string(i));
+		for (size_t j = 0; j < dest_count; ++j)
+			DEST::add("d" + std::to_string(j));
+
+		long total = 0;
+		for (size_t j = 0; j < dest_count; ++j)
+		{
+			int value = demand_data(random);
+			total += value;
+			demand.add("d" + std::to_string(j), value);
+		}
+
+		// supply matches demand exactly so that the equality rows are feasible
+		for (size_t i = 0; i < orig_count; ++i)
+		{
+			long value = total / (long)orig_count + (i == 0 ? total % (long)orig_count : 0);
+			supply.add("o" + std::to_string(i), (double)value);
+		}
+
+		for (size_t i = 0; i < orig_count; ++i)
+			for (size_t j = 0; j < dest_count; ++j)
+				cost.add("o" + std::to_string(i), "d" + std::to_string(j), cost_data(random));
+
+		m.seal_data();
+	});
+
+	state.phase("generation", [&] {
+		minimize("Total_Cost",
+			sum([&](ORIG i, DEST j) { return cost(i, j)*Trans(i, j); }
+		));
+
+		subject_to("Supply", [&](ORIG i) {
+			return sum([&](DEST j) { return Trans(i, j); }) == supply(i);
+		});
+
+		subject_to("Demand", [&](DEST j) {
+			return sum([&](ORIG i) { return Trans(i, j); }) == demand(j);
+		});
+	});
+
+	state.count(m);
+	state.solve(m);
+}
@@ -0,0 +1,201 @@
+#include <milpcpp/milpcpp.h>
+#include <milpcpp/glpk.h>
+
+#include <milpcpp/benders.h>
+#include <milpcpp/enumerate.h>
+
+#include<cassert>
+#include<cmath>
+#include<iostream>
+
+// Two stage capacity planning: plants are built before demand is known,
+// then each scenario ships what it can and pays for what it cannot
+/*
+set PLANT;    # candidate plants
+set MARKET;   # markets served
+set SCEN;     # demand scenarios
+
+param buildcost {PLANT} >= 0;       # cost per ton of capacity
+param maxcap {PLANT} >= 0;          # capacity that can be built
+param shipcost {PLANT,MARKET} >= 0; # cost per ton shipped
+param demand {MARKET,SCEN} >= 0;    # tons required in scenario
+param maxshort {MARKET,SCEN} >= 0;  # tons that may go unserved
+param prob {SCEN} > 0;              # probability of scenario
+param penalty > 0;                  # cost per ton unserved
+
+var Build {p in PLANT} >= 0, <= maxcap[p];
+var Ship {PLANT,MARKET,SCEN} >= 0;
+var Short {m in MARKET, s in SCEN} >= 0, <= maxshort[m,s];
+
+minimize Expected_Cost:
+sum {p in PLANT} buildcost[p] * Build[p] +
+sum {s in SCEN} prob[s] * (sum {p in PLANT, m in MARKET} shipcost[p,m] * Ship[p,m,s] +
+sum {m in MARKET} penalty * Short[m,s]);
+
+subject to Capacity {p in PLANT, s in SCEN}:
+sum {m in MARKET} Ship[p,m,s] <= Build[p];
+
+subject to Demand {m in MARKET, s in SCEN}:
+sum {p in PLANT} Ship[p,m,s] + Short[m,s] >= demand[m,s];
+*/
+
+
+
+void capacity(
+	const std::vector<std::string>& PLANT_data,
+	const std::vector<std::string>& MARKET_data,
+	const std::vector<std::string>& SCEN_data,
+	const std::vector<double>& buildcost_data,
+	const std::vector<double>& maxcap_data,
+	const std::vector<std::vector<double>>& shipcost_data,
+	const std::vector<std::vector<double>>& demand_data,
+	const std::vector<double>& prob_data,
+	double shortfraction_data,
+	double penalty_data)
+{
+	using namespace milpcpp;
+
+	model m;
+
+	MILPCPP_SET(PLANT);
+	MILPCPP_SET(MARKET);
+	MILPCPP_SET(SCEN);
+
+	param<PLANT>          buildcost(greater_equal(0));
+	param<PLANT>          maxcap(greater_equal(0));
+	param<PLANT, MARKET>  shipcost(greater_equal(0));
+	param<MARKET, SCEN>   demand(greater_equal(0));
+	param<MARKET, SCEN>   maxshort(greater_equal(0));
+	param<SCEN>           prob(greater_than(0));
+	param<>               penalty(greater_than(0));
+
+	var<PLANT>                Build(greater_equal(0), less_equal([&](PLANT p) { return maxcap(p); }));
+	var<PLANT, MARKET, SCEN>  Ship(greater_equal(0));
+	var<MARKET, SCEN>         Short(greater_equal(0), less_equal([&](MARKET k, SCEN s) { return maxshort(k, s); }));
+
+
+	//////////////////////////////////////////////////////////
+	// Start data
+
+	for (const auto& p : PLANT_data)
+		PLANT::add(p);
+
+	for (const auto& k : MARKET_data)
+		MARKET::add(k);
+
+	for (const auto& s : SCEN_data)
+		SCEN::add(s);
+
+	for (const auto&[data_index, p] : utils::enumerate(PLANT_data))
+	{
+		buildcost.add(p, buildcost_data[data_index]);
+		maxcap.add(p, maxcap_data[data_index]);
+		for (const auto&[data_index2, k] : utils::enumerate(MARKET_data))
+			shipcost.add(p, k, shipcost_data[data_index][data_index2]);
+	}
+
+	for (const auto&[data_index, k] : utils::enumerate(MARKET_data))
+	{
+		for (const auto&[data_index2, s] : utils::enumerate(SCEN_data))
+		{
+			demand.add(k, s, demand_data[data_index][data_index2]);
+			maxshort.add(k, s, shortfraction_data * demand_data[data_index][data_index2]);
+		}
+	}
+
+	for (const auto&[data_index, s] : utils::enumerate(SCEN_data))
+		prob.add(s, prob_data[data_index]);
+
+	penalty = penalty_data;
+
+	m.seal_data();
+	// End data
+	//////////////////////////////////////////////////////////
+
+
+
+
+	minimize("Expected_Cost",
+		sum([&](PLANT p) { return buildcost(p) * Build(p); }) +
+		sum([&](PLANT p, MARKET k, SCEN s) { return prob(s) * shipcost(p, k) * Ship(p, k, s); }) +
+		sum([&](MARKET k, SCEN s) { return prob(s) * penalty * Short(k, s); })
+	);
+
+	subject_to("Capacity", [&](PLANT p, SCEN s) {
+		return 0 <= Build(p) - sum([&](MARKET k) { return Ship(p, k, s); });
+	});
+
+	subject_to("Demand", [&](MARKET k, SCEN s) {
+		return demand(k, s) <= sum([&](PLANT p) { return Ship(p, k, s); }) + Short(k, s);
+	});
+
+	// Solve
+
+	double monolithic;
+	{	// Solve using glpk
+		std::cout << "glpk" << std::endl;
+
+		glpk solver(&m);
+		solver.solve();
+
+		solver.get_values(Build, [](auto value, PLANT p) {
+			std::cout << "Build: " << p.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		monolithic = solver.get_objective_value();
+		assert(long(monolithic + 0.5) == 344239);
+	}
+
+	{	// Solve by Benders decomposition over the scenarios
+		std::cout << "glpk, Benders" << std::endl;
+
+		benders decomposition(&m);
+		decomposition.add_first_stage(Build);
+		decomposition.set_scenarios<SCEN>();
+
+		benders_report report = decomposition.solve();
+		report.write_json(std::cout);
+		std::cout << std::endl;
+
+		decomposition.get_values(Build, [](auto value, PLANT p) {
+			std::cout << "Build: " << p.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << decomposition.get_objective_value() << std::endl;
+
+		// Too little capacity leaves more demand than may go unserved
+		assert(report._status == solve_status::optimal && report._feasibility_cuts != 0);
+		assert(std::abs(decomposition.get_objective_value() - monolithic) < 1e-6 * monolithic);
+	}
+
+}
+
+void capacity()
+{
+	std::vector<std::string> PLANT_data{ "GARY", "CLEV", "PITT" };
+	std::vector<std::string> MARKET_data{ "FRA", "DET", "LAN", "WIN", "STL" };
+	std::vector<std::string> SCEN_data{ "low", "base", "high", "peak" };
+
+	std::vector<double> buildcost_data{ 40, 35, 45 };
+	std::vector<double> maxcap_data{ 3000, 2500, 3500 };
+
+	std::vector<std::vector<double>> shipcost_data{
+		{ 39,  14,  11,  14,  16 },
+		{ 27,   9,  12,   9,  26 },
+		{ 24,  14,  17,  13,  28 }
+	};
+
+	std::vector<std::vector<double>> demand_data{
+		{  700,   900,  1100,  1400 },
+		{  900,  1200,  1500,  1800 },
+		{  400,   600,   700,   900 },
+		{  300,   400,   500,   700 },
+		{ 1300,  1700,  2000,  2600 }
+	};
+
+	std::vector<double> prob_data{ 0.2, 0.4, 0.3, 0.1 };
+
+	capacity(PLANT_data, MARKET_data, SCEN_data, buildcost_data, maxcap_data, shipcost_data, demand_data, prob_data, 0.1, 150);
+}
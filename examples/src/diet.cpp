@@ -1,6 +1,9 @@
 #include <milpcpp/milpcpp.h>
+#include <milpcpp/dual_simplex.h>
 #include <milpcpp/glpk.h>
 #include <milpcpp/lp_solve.h>
+#include <milpcpp/highs.h>
+#include <milpcpp/cbc.h>
 
 #include <milpcpp/enumerate.h>
 
@@ -132,6 +135,28 @@ void diet(
 		assert(optimum == 882);
 	}
 
+	{	// A limited solve must not be served to an unlimited one from the cache
+		std::cout << "glpk cached" << std::endl;
+
+		lru_cache cache(4);
+		glpk::options o;
+		o._time_limit = 0;
+		o._iteration_limit = 1;
+		glpk limited(&m, o);
+		limited.set_cache(&cache);
+		solve_result first = limited.solve();
+
+		glpk solver(&m);
+		solver.set_cache(&cache);
+		solve_result second = solver.solve();
+		assert(first.optimal() || !second._cache_hit);
+		assert(second.optimal());
+		assert(solver.solve()._cache_hit);
+
+		long optimum = long(solver.get_objective_value() * 10 + 0.5);
+		assert(optimum == 882);
+	}
+
 	{	// Solve using lp_solve
 		std::cout << "lp_solve" << std::endl;
 
@@ -147,6 +172,58 @@ void diet(
 		long optimum = long(solver.get_objective_value() * 10 + 0.5);
 		assert(optimum == 882);	}
 
+	{	// Solve using the built in dual simplex
+		std::cout << "dual_simplex" << std::endl;
+
+		dual_simplex solver(&m);
+		solver.solve();
+
+		solver.get_values(Buy, [](auto value, auto i) {
+			std::cout << i.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		long optimum = long(solver.get_objective_value() * 10 + 0.5);
+		assert(optimum == 882);
+	}
+
+#ifdef MILPCPP_WITH_HIGHS
+	{	// Solve using HiGHS
+		std::cout << "highs" << std::endl;
+
+		highs solver(&m);
+		solver.solve();
+
+		solver.get_values(Buy, [](auto value, auto i) {
+			std::cout << i.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		long optimum = long(solver.get_objective_value() * 10 + 0.5);
+		assert(optimum == 882);
+	}
+#endif
+
+#ifdef MILPCPP_WITH_CBC
+	{	// Solve using CBC
+		std::cout << "cbc" << std::endl;
+
+		cbc solver(&m);
+		solver.solve();
+
+		solver.get_values(Buy, [](auto value, auto i) {
+			std::cout << i.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		long optimum = long(solver.get_objective_value() * 10 + 0.5);
+		assert(optimum == 882);
+	}
+#endif
+
 }
 
 void diet()
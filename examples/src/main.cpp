@@ -4,12 +4,14 @@ void steel3();
 void steel4();
 void diet();
 void transp();
+void transpl();
 void multi();
 void steelP();
 void steelT();
 void steelT2();
 //void dietu();
 void steelT2initlist();
+void capacity();
 
 int main(int argc, char *argv[])
 {
@@ -19,11 +21,13 @@ int main(int argc, char *argv[])
 	steel4();
 	diet();
 	transp();
+	transpl();
 	multi(); 
 	steelP();
 	steelT();
 	steelT2();
 	//dietu();
 	steelT2initlist();
+	capacity();
 }
 
@@ -1,6 +1,8 @@
 #include <milpcpp/milpcpp.h>
 #include <milpcpp/glpk.h>
 #include <milpcpp/lp_solve.h>
+#include <milpcpp/highs.h>
+#include <milpcpp/cbc.h>
 
 #include <milpcpp/enumerate.h>
 
@@ -168,6 +170,40 @@ void multi(
 		assert(long(solver.get_objective_value() + 0.5) == 199500);
 	}
 
+#ifdef MILPCPP_WITH_HIGHS
+	{	// Solve using HiGHS
+		std::cout << "highs" << std::endl;
+
+		highs solver(&m);
+		solver.solve();
+
+		solver.get_values(Trans, [](auto value, ORIG i, DEST j, PROD k) {
+			std::cout << i.name() << "," << j.name() << "," << k.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		assert(long(solver.get_objective_value() + 0.5) == 199500);
+	}
+#endif
+
+#ifdef MILPCPP_WITH_CBC
+	{	// Solve using CBC
+		std::cout << "cbc" << std::endl;
+
+		cbc solver(&m);
+		solver.solve();
+
+		solver.get_values(Trans, [](auto value, ORIG i, DEST j, PROD k) {
+			std::cout << i.name() << "," << j.name() << "," << k.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		assert(long(solver.get_objective_value() + 0.5) == 199500);
+	}
+#endif
+
 }
 
 void multi()
@@ -1,10 +1,12 @@
 #include <milpcpp/milpcpp.h>
+#include <milpcpp/dual_simplex.h>
 #include <milpcpp/glpk.h>
 #include <milpcpp/lp_solve.h>
 
 #include <milpcpp/enumerate.h>
 
 #include<cassert>
+#include<cmath>
 #include<iostream>
 
 // AMPL model to translate
@@ -80,6 +82,7 @@ void steel(
 
 	// Solve
 
+	double glpk_objective;
 	{	// Solve using glpk
 		std::cout << "glpk" << std::endl;
 
@@ -93,6 +96,22 @@ void steel(
 		std::cout << "objective = " << solver.get_objective_value() << std::endl;
 
 		assert(long(solver.get_objective_value() + 0.5) == 192000);
+		glpk_objective = solver.get_objective_value();
+	}
+
+	{	// Solve using the built in dual simplex
+		std::cout << "dual_simplex" << std::endl;
+
+		dual_simplex solver(&m);
+		solver.solve();
+
+		solver.get_values(Make, [](auto value, auto i) {
+			std::cout << i.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		assert(std::abs(solver.get_objective_value() - glpk_objective) < 1e-6 * std::abs(glpk_objective));
 	}
 
 	{	// Solve using lp_solve
@@ -111,6 +130,67 @@ void steel(
 	}
 }
 
+// The same model with the rows streamed into glpk as they are generated;
+// the market bounds are halved after attach(), before the solve
+void steel_attached(
+	const std::vector<std::string>& PROD_data,
+	const std::vector<double>& rate_data,
+	double avail_data,
+	const std::vector<double>& profit_data,
+	const std::vector<double>& market_data)
+{
+	using namespace milpcpp;
+
+	model m;
+
+	MILPCPP_SET(PROD);
+
+	param<PROD> rate(greater_than(0));
+	param<>     avail(greater_equal(0));
+
+	param<PROD> profit;
+	param<PROD> market(greater_equal(0));
+	param<>     share;
+
+	var<PROD>   Make(greater_equal(0), less_equal([&](PROD p) { return market(p) * share; }));
+
+	for (const auto& p : PROD_data)
+		PROD::add(p);
+
+	for (const auto&[data_index, p] : utils::enumerate(PROD_data))
+	{
+		rate.add(p, rate_data[data_index]);
+		profit.add(p, profit_data[data_index]);
+		market.add(p, market_data[data_index]);
+	}
+
+	avail = avail_data;
+	share = 1;
+
+	m.seal_data();
+
+	std::cout << "glpk attached" << std::endl;
+
+	glpk solver(&m);
+	solver.attach();
+
+	maximize("Total_Profit", sum([&](PROD p) { return profit(p)*Make(p);  }) );
+
+	subject_to("Time", sum([&](PROD p) { return (1 / rate(p)) * Make(p); }) <= avail );
+
+	share = 0.5;
+	Make.set_integer();
+	solver.solve();
+
+	solver.get_values(Make, [](auto value, auto i) {
+		std::cout << i.name() << " = " << value << std::endl;
+	});
+
+	std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+	assert(long(solver.get_objective_value() + 0.5) == 135000);
+}
+
 void steel()
 {
 	std::vector<std::string> PROD_data{ "bands", "coils" };
@@ -120,4 +200,5 @@ void steel()
 	std::vector<double> market_data{ 6000, 4000 };
 
 	steel(PROD_data, rate_data, avail_data, profit_data, market_data);
+	steel_attached(PROD_data, rate_data, avail_data, profit_data, market_data);
 }
@@ -1,8 +1,11 @@
 #include <milpcpp/milpcpp.h>
 #include <milpcpp/glpk.h>
 #include <milpcpp/lp_solve.h>
+#include <milpcpp/highs.h>
+#include <milpcpp/cbc.h>
 
 #include <milpcpp/enumerate.h>
+#include <milpcpp/rolling_horizon.h>
 
 #include<cassert>
 #include<iostream>
@@ -85,7 +88,7 @@ void steelT(
 
 	var<PROD, range<1, T>>    Make(greater_equal(0));
 	var<PROD, range<0, T>>    Inv(greater_equal(0));
-	var<PROD, range<1, T>>    Sell(greater_equal(0), less_equal([&](PROD p, range<1, T> t) { return market(p, t); }));
+	var<PROD, range<1, T>>    Sell(greater_equal(0), less_equal(market));
 
 
 	//////////////////////////////////////////////////////////
@@ -140,6 +143,15 @@ void steelT(
 		return Make(p, t) + Inv(p, t - 1) == Sell(p, t) + Inv(p, t);
 	});
 
+	// Each product's rows use only its own variables, Time links them
+	block_structure blocks = m.detect_blocks();
+	assert(blocks._blocks == 2 && blocks.linking_column_count() == 0);
+	assert(blocks._linking_families == std::vector<std::string>{ "Time" });
+	assert(m.detect_blocks<PROD>()._row_block == blocks._row_block);
+
+	// Init_Inv rows become fixed columns
+	m.presolve();
+
 	// Solve
 
 	{	// Solve using glpk
@@ -189,6 +201,79 @@ void steelT(
 		assert(long(solver.get_objective_value() + 0.5) == 515033);
 	}
 
+#ifdef MILPCPP_WITH_HIGHS
+	{	// Solve using HiGHS
+		std::cout << "highs" << std::endl;
+
+		highs solver(&m);
+		solver.solve();
+
+		solver.get_values(Make, [&](auto value, auto i, auto k) {
+			std::cout << "Make: " << i.name() << "," << k.name() << " = " << value << std::endl;
+		});
+
+		solver.get_values(Inv, [&](auto value, auto i, auto j) {
+			std::cout << "Inv: " << i.name() << "," << j.name() << " = " << value << std::endl;
+		});
+
+		solver.get_values(Sell, [&](auto value, auto i, auto j) {
+			std::cout << "Sell: " << i.name() << "," << j.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		assert(long(solver.get_objective_value() + 0.5) == 515033);
+	}
+#endif
+
+#ifdef MILPCPP_WITH_CBC
+	{	// Solve using CBC
+		std::cout << "cbc" << std::endl;
+
+		cbc solver(&m);
+		solver.solve();
+
+		solver.get_values(Make, [&](auto value, auto i, auto k) {
+			std::cout << "Make: " << i.name() << "," << k.name() << " = " << value << std::endl;
+		});
+
+		solver.get_values(Inv, [&](auto value, auto i, auto j) {
+			std::cout << "Inv: " << i.name() << "," << j.name() << " = " << value << std::endl;
+		});
+
+		solver.get_values(Sell, [&](auto value, auto i, auto j) {
+			std::cout << "Sell: " << i.name() << "," << j.name() << " = " << value << std::endl;
+		});
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		assert(long(solver.get_objective_value() + 0.5) == 515033);
+	}
+#endif
+
+	{	// Solve two weeks at a time, committing one
+		std::cout << "glpk, rolling horizon" << std::endl;
+
+		glpk solver(&m);
+		rolling_horizon_options options;
+		options._window = 2;
+		options._overlap = 1;
+		options._monolithic = true;
+		rolling_horizon horizon(&m, &solver, options);
+		horizon.add<range<1, T>>(Make);
+		horizon.add<range<0, T>>(Inv);
+		horizon.add<range<1, T>>(Sell);
+
+		rolling_horizon_report report = horizon.solve();
+		report.write_json(std::cout);
+		std::cout << std::endl;
+
+		// Looking a week ahead finds the inventory the monolithic plan builds
+		assert(report._windows.size() == 4);
+		assert(long(report._objective.value() + 0.5) == 515033);
+		assert(long(solver.get_objective_value() + 0.5) == 515033);
+	}
+
 }
 
 void steelT()
@@ -137,11 +137,8 @@ void steelT2(
 			Sell(p, first<WEEKS>()) + Inv(p, first<WEEKS>());
 	});
 
-	subject_to("Balance", [&](PROD p, WEEKS t) {
-		if (ord(t) > 1)
-			return Make(p, t) + Inv(p, prev(t)) == Sell(p, t) + Inv(p, t);
-		else
-			return null_constraint();
+	subject_to("Balance", from(next(first<WEEKS>())), [&](PROD p, WEEKS t) {
+		return Make(p, t) + Inv(p, prev(t)) == Sell(p, t) + Inv(p, t);
 	});
 
 	// Solve
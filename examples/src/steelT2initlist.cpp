@@ -102,11 +102,8 @@ void steelT2initlist()
 			Sell(p, first<WEEKS>()) + Inv(p, first<WEEKS>());
 	});
 
-	subject_to("Balance", [&](PROD p, WEEKS t) {
-		if (ord(t) > 1)
-			return Make(p, t) + Inv(p, prev(t)) == Sell(p, t) + Inv(p, t);
-		else
-			return null_constraint();
+	subject_to("Balance", such_that([&](PROD p, WEEKS t) { return ord(t) > 1; }), [&](PROD p, WEEKS t) {
+		return Make(p, t) + Inv(p, prev(t)) == Sell(p, t) + Inv(p, t);
 	});
 
 	// Solve
@@ -0,0 +1,188 @@
+#include <milpcpp/milpcpp.h>
+#include <milpcpp/dual_simplex.h>
+#include <milpcpp/glpk.h>
+#include <milpcpp/lp_solve.h>
+
+#include <milpcpp/enumerate.h>
+
+#include<cassert>
+#include<cmath>
+#include<iostream>
+#include<limits>
+
+// AMPL model to translate
+// From the book: "AMPL: A Modeling Language for Mathematical Programming" 
+// http://ampl.com/resources/the-ampl-book/
+// transpl1.mod (Chapter 17)
+/*
+set ORIG;   # origins
+set DEST;   # destinations
+
+param supply {ORIG} >= 0;   # amounts available at origins
+param demand {DEST} >= 0;   # amounts required at destinations
+
+check: sum {i in ORIG} supply[i] = sum {j in DEST} demand[j];
+
+param rate1 {i in ORIG, j in DEST} >= 0;
+param rate2 {i in ORIG, j in DEST} >= rate1[i,j];
+param rate3 {i in ORIG, j in DEST} >= rate2[i,j];
+
+param limit1 {i in ORIG, j in DEST} > 0;
+param limit2 {i in ORIG, j in DEST} > limit1[i,j];
+
+var Trans {ORIG,DEST} >= 0;    # units to be shipped
+
+minimize Total_Cost:
+   sum {i in ORIG, j in DEST} 
+      <<limit1[i,j], limit2[i,j]; 
+        rate1[i,j], rate2[i,j], rate3[i,j]>> Trans[i,j];
+
+subject to Supply {i in ORIG}:
+   sum {j in DEST} Trans[i,j] = supply[i];
+
+subject to Demand {j in DEST}:
+   sum {i in ORIG} Trans[i,j] = demand[j];
+*/
+
+// The data is transp.dat's, with the cost as first rate, rising by half
+// above 300 units and doubling above 600
+
+void transpl(
+	const std::vector<std::string>& ORIG_data, 
+	const std::vector<std::string>& DEST_data,
+	const std::vector<double>& supply_data,
+	const std::vector<double>& demand_data,
+	const std::vector<std::vector<double> >& cost_data,
+	const std::vector<double>& limit_data,
+	const std::vector<double>& increase_data
+	)
+{
+	using namespace milpcpp;
+
+	model m;
+
+	MILPCPP_SET(ORIG);
+	MILPCPP_SET(DEST);
+	MILPCPP_FIXED_SET(PIECE, "1", "2", "3");
+
+	param<ORIG> supply(greater_equal(0));
+	param<DEST> demand(greater_equal(0));
+
+	// The rate of each piece, and where it ends; the last piece has no end
+	param<ORIG, DEST, PIECE> rate(greater_equal(0));
+	param<ORIG, DEST, PIECE> limit(greater_than(0));
+
+	var<ORIG, DEST> Trans(greater_equal(0));
+
+	// Rising rates are convex, the automatic encoding is a plain LP
+	piecewise<PIECE, ORIG, DEST> Cost(limit, rate);
+
+	//////////////////////////////////////////////////////////
+	// Start data
+	for(const auto& n: ORIG_data)
+		ORIG::add(n);
+
+	for (const auto& f :DEST_data)
+		DEST::add(f);
+
+	for (const auto&[data_index, o] : utils::enumerate(ORIG_data))
+	{
+		supply.add(o, supply_data[data_index]);
+	}
+
+	for (const auto&[data_index, d] : utils::enumerate(DEST_data))
+	{
+		demand.add(d, demand_data[data_index]);
+	}
+
+	for (const auto&[data_index, o] : utils::enumerate(ORIG_data))
+	{
+		for (const auto&[data_index2, d] : utils::enumerate(DEST_data))
+		{
+			for (size_t p = 0; p < PIECE::size(); ++p)
+			{
+				rate.add(o, d, PIECE::name(p), cost_data[data_index][data_index2] * increase_data[p]);
+				limit.add(o, d, PIECE::name(p), limit_data[p]);
+			}
+		}
+	}
+
+	m.seal_data();
+
+	// End data
+	//////////////////////////////////////////////////////////
+
+	assert(Cost.encoding() == piecewise_encoding::lp);
+
+	minimize("Total_Cost", 
+		sum([&](ORIG i, DEST j) { return Cost(i, j); }
+	));
+
+	Cost.link("Cost", [&](ORIG i, DEST j) { return Trans(i, j); });
+
+	subject_to("Supply", [&](ORIG i) {
+		return sum([&](DEST j) { return Trans(i,j); }) == supply(i);
+	});
+
+	subject_to("Demand", [&](DEST j) {
+		return sum([&](ORIG i) { return Trans(i, j); }) == demand(j);
+	});
+
+	// Solve
+
+	double glpk_objective;
+	{	// Solve using glpk
+		std::cout << "glpk" << std::endl;
+
+		glpk solver(&m);
+		solver.solve();
+
+		solver.get_values(Trans, [](auto value, ORIG i, DEST j) {
+			std::cout << i.name() << "," << j.name() << " = " << value << std::endl;
+		});
+
+		glpk_objective = solver.get_objective_value();
+		std::cout << "objective = " << glpk_objective << std::endl;
+
+		assert(long(glpk_objective + 0.5) == 228500);
+	}
+
+	{	// Solve using the built in dual simplex
+		std::cout << "dual_simplex" << std::endl;
+
+		dual_simplex solver(&m);
+		solver.solve();
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		assert(std::abs(solver.get_objective_value() - glpk_objective) < 1e-6 * std::abs(glpk_objective));
+	}
+
+	{	// Solve using lp_solve
+		std::cout << "lp_solve" << std::endl;
+
+		lp_solve solver(&m);
+		solver.solve();
+
+		std::cout << "objective = " << solver.get_objective_value() << std::endl;
+
+		assert(long(solver.get_objective_value() + 0.5) == 228500);
+	}
+}
+
+void transpl()
+{
+	std::vector<std::string> ORIG_data{"GARY", "CLEV", "PITT"};
+	std::vector<std::string> DEST_data{"FRA","DET","LAN","WIN","STL","FRE","LAF" };
+	std::vector<double> supply_data{ 1400, 2600, 2900};
+	std::vector<double> demand_data{ 900, 1200, 600, 400, 1700, 1100, 1000 };
+	std::vector<std::vector<double> > cost_data{
+		{   39,   14,  11,   14,   16,   82,    8},
+		{   27,    9,   12,    9,   26,   95,   17},
+		{   24,   14,   17,   13,   28,   99,   20}
+	};
+	std::vector<double> limit_data{ 300, 600, std::numeric_limits<double>::infinity() };
+	std::vector<double> increase_data{ 1, 1.5, 2 };
+
+	transpl(ORIG_data, DEST_data, supply_data, demand_data, cost_data, limit_data, increase_data);
+}
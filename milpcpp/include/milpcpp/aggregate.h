@@ -1,107 +1,160 @@
 #ifndef __MILPCPP_AGGREGATE_H__
 #define __MILPCPP_AGGREGATE_H__
 
-#include<functional>
+#include<tuple>
+#include<type_traits>
 
+#include<milpcpp/domain.h>
 #include<milpcpp/expressions.h>
 #include<milpcpp/model.h>
+#include<milpcpp/profiler.h>
 
 namespace milpcpp
 {
-	template<typename T1, typename...Ts>
-	expression get_sum(const std::function<expression(T1, Ts...)>& f)
+	namespace aggregates
 	{
-		expressions::sum result;
-		size_t size = T1::size();
-		for (size_t i = 0; i < size; ++i)
+		// Nested loops over the index types Ts, the last innermost, within
+		// the bounds the slices give them; f gets each tuple of indices
+		template<typename...Ts>
+		struct loop;
+
+		template<>
+		struct loop<>
+		{
+			template<typename S, typename F, typename...Is>
+			static void run(const S&, const F& f, const Is&...indices) { f(indices...); }
+		};
+
+		template<typename T1, typename...Ts>
+		struct loop<T1, Ts...>
 		{
-			auto f2 = [=](Ts...args)
+			template<typename S, typename F, typename...Is>
+			static void run(const S& slices, const F& f, const Is&...indices)
 			{
-				return f(T1(i), args...);
-			};
+				auto[begin, end] = domains::bounds<T1>(slices);
+				for (size_t i = begin; i < end; ++i)
+					loop<Ts...>::run(slices, f, indices..., T1(i));
+			}
+		};
+
+		template<typename A>
+		struct loop_over;
 
-			auto sum_expr = get_sum<Ts...>(f2);
-			add(result, sum_expr);
+		template<typename...Ts>
+		struct loop_over<std::tuple<Ts...>>
+		{
+			typedef loop<std::decay_t<Ts>...> type;
+		};
+
+		// Calls f with every index tuple the lambda L takes; the callables
+		// are passed on as they are, nothing is type erased per row
+		template<typename L, typename S, typename F>
+		void for_each(const S& slices, const F& f)
+		{
+			loop_over<typename utils::function_traits<L>::arguments>::type::run(slices, f);
 		}
-		return result;
-	}
 
-	template<typename T>
-	expression get_sum(const std::function<expression(T)>& f)
-	{
-		expressions::sum result;
-		size_t size = T::size();
-		for (size_t i = 0; i < size; ++i)
+		template<typename S, typename P, typename F>
+		expression sum(const S& slices, const P& predicate, const F& f)
 		{
-			add(result, f(T(i)));
+			expressions::sum result;
+			for_each<F>(slices, [&](const auto&...indices) {
+				expression e;
+				{
+					MILPCPP_PROFILE(lambda);
+					if (!predicate(indices...))
+						return;
+					e = f(indices...);
+				}
+				MILPCPP_PROFILE(arithmetic);
+				add(result, e);
+			});
+			return result;
 		}
-		return result;
-	}
+
+		// Rows are handed to the model one at a time, so a streaming model
+		// never holds more than the row being generated
+		template<typename S, typename P, typename F>
+		void constraints(const S& slices, const P& predicate, const F& f)
+		{
+			for_each<F>(slices, [&](const auto&...indices) {
+				constraint c;
+				{
+					MILPCPP_PROFILE(lambda);
+					if (!predicate(indices...))
+						return;
+					c = f(indices...);
+				}
+				MILPCPP_PROFILE(container);
+				model::add_constraint(std::move(c));
+			});
+		}
+	};
 
 	template<typename T>
 	expression sum(T f)
 	{
-		typedef utils::function_traits<T> traits;
-		typedef traits::function_type F;
-		F func(f);
-		return get_sum(func);
+		return aggregates::sum(std::tuple<>(), domains::all(), f);
+	}
+
+	template<typename P, typename...Ss, typename T>
+	expression sum(const domain<P, Ss...>& d, T f)
+	{
+		return aggregates::sum(d._slices, d._predicate, f);
 	}
 
+	template<typename S, typename T>
+	expression sum(const slice<S>& s, T f) { return sum(over(s), f); }
+
 	inline void maximize(const char * name, expression&&e)
 	{
+		compact(e);
+		if (profiling::profiler::current())
+			profiling::profiler::current()->add_objective(name, term_count(e));
 		model::set_objective(std::move(e));
 		model::set_maximixe();
 	}
 
 	inline void minimize(const char * name, expression&&e)
 	{
+		compact(e);
+		if (profiling::profiler::current())
+			profiling::profiler::current()->add_objective(name, term_count(e));
 		model::set_objective(std::move(e));
 		model::set_minimize();
 	}
 
-	template<typename T1, typename...Ts>
-	std::vector<constraint> get_constraints(const std::function<constraint(T1,Ts...)>& f)
-	{
-		std::vector<constraint> result;
-		size_t size = T1::size();
-		for (size_t i = 0; i < size; ++i)
-		{
-			auto f2 = [=](Ts...args) 
-			{ 
-				return f(T1(i), args...);
-			};
-
-			auto constraints = get_constraints<Ts...>(f2);
-			std::move(constraints.begin(), constraints.end(), std::back_inserter(result));
-		}
-		return result;
-	}
-
 	template<typename T>
-	std::vector<constraint> get_constraints(const std::function<constraint(T)>& f)
+	inline void subject_to(const char * name, const T&f)
 	{
-		std::vector<constraint> result;
-		size_t size = T::size();
-		for (size_t i = 0; i < size; ++i)
-		{
-			result.push_back(f(T(i)));
-		}
-		return result;
+		profiling::family_scope family(name, profiling::family_kind::constraints);
+		model::begin_family(name);
+		aggregates::constraints(std::tuple<>(), domains::all(), f);
+		if (family.active())
+			family.add_rows(model::current_family()._row_count, model::current_family()._nonzero_count);
 	}
 
-	template<typename T>
-	inline void subject_to(const char * name, const T&f)
+	template<typename P, typename...Ss, typename T>
+	inline void subject_to(const char * name, const domain<P, Ss...>& d, const T&f)
 	{
-		typedef utils::function_traits<T> traits;
-		typedef traits::function_type F;
-		F func(f);
-		model::add_constraints(get_constraints(func));
+		profiling::family_scope family(name, profiling::family_kind::constraints);
+		model::begin_family(name);
+		aggregates::constraints(d._slices, d._predicate, f);
+		if (family.active())
+			family.add_rows(model::current_family()._row_count, model::current_family()._nonzero_count);
 	}
 
+	template<typename S, typename T>
+	inline void subject_to(const char * name, const slice<S>& s, const T&f) { subject_to(name, over(s), f); }
+
 	template<>
 	inline void subject_to<constraint>(const char * name, const constraint&c)
 	{
-		model::add_constraints(std::vector<constraint>{c});
+		profiling::family_scope family(name, profiling::family_kind::constraints);
+		model::begin_family(name);
+		family.add_rows(1, term_count(c._expression));
+		MILPCPP_PROFILE(container);
+		model::add_constraint(constraint(c));
 	}
 }
 
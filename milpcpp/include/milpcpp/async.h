@@ -0,0 +1,113 @@
+#ifndef __MILPCPP_ASYNC_H__
+#define __MILPCPP_ASYNC_H__
+
+#include<chrono>
+#include<exception>
+#include<functional>
+#include<future>
+#include<memory>
+#include<optional>
+
+#include<milpcpp/progress.h>
+#include<milpcpp/solve_result.h>
+
+namespace milpcpp
+{
+	// Handle on a solve running on another thread. The backend and its model
+	// must outlive the solve and must not be used until it has finished.
+	class solve_handle
+	{
+		std::future<solve_result> _future;
+		cancellation _cancellation;
+	public:
+		solve_handle(std::future<solve_result>&& f, const cancellation& c) : _future(std::move(f)), _cancellation(c) {}
+		solve_handle(solve_handle&&) = default;
+		solve_handle& operator=(solve_handle&&) = default;
+
+		// Asks the backend to stop at its next callback; the solve then
+		// finishes with whatever the solver had when it stopped.
+		void cancel() { _cancellation.cancel(); }
+		const cancellation& get_cancellation() const { return _cancellation; }
+
+		bool ready() const { return _future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+		void wait() const { _future.wait(); }
+
+		template<typename Rep, typename Period>
+		bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+		{
+			return _future.wait_for(timeout) == std::future_status::ready;
+		}
+
+		// Waits and returns the result or rethrows an exception thrown by
+		// solve(); callable once
+		solve_result get() { return _future.get(); }
+	};
+
+	// The handle's token is linked to the cancellation the backend already
+	// had, so that its deadline still holds; the backend gets that one back
+	// once the solve is over. Only a cancellation set on the backend before
+	// lets a solver split its work to check it, as the glpk simplex does;
+	// without one, cancel() takes effect at the solver's next callback, for
+	// glpk in branch and bound or once the simplex is done.
+	template<typename Backend>
+	cancellation link_cancellation(Backend& backend)
+	{
+		const auto& own = backend.get_cancellation();
+		return own.has_value() ? own->linked() : cancellation();
+	}
+
+	// Runs backend.solve() through executor, any callable taking a
+	// std::function<void()> such as a thread pool's post. The pool thread
+	// only runs the solve: nothing waits on it, and on_done, if given, is
+	// called on that thread once the solve has finished or thrown.
+	template<typename Backend, typename Executor>
+	solve_handle solve_async(Backend& backend, Executor&& executor, std::function<void()> on_done = {})
+	{
+		std::optional<cancellation> own = backend.get_cancellation();
+		cancellation token = link_cancellation(backend);
+		backend.set_cancellation(token, own.has_value());
+		auto promise = std::make_shared<std::promise<solve_result>>();
+		solve_handle handle(promise->get_future(), token);
+		executor(std::function<void()>([&backend, own, promise, on_done]() {
+			try
+			{
+				solve_result result = backend.solve();
+				backend.set_cancellation(own);
+				promise->set_value(result);
+			}
+			catch (...)
+			{
+				backend.set_cancellation(own);
+				promise->set_exception(std::current_exception());
+			}
+			if (on_done)
+				on_done();
+		}));
+		return handle;
+	}
+
+	// Runs backend.solve() on a thread of its own. Like std::async, the
+	// handle waits for the solve when it is destroyed.
+	template<typename Backend>
+	solve_handle solve_async(Backend& backend)
+	{
+		std::optional<cancellation> own = backend.get_cancellation();
+		cancellation token = link_cancellation(backend);
+		backend.set_cancellation(token, own.has_value());
+		return solve_handle(std::async(std::launch::async, [&backend, own]() {
+			try
+			{
+				solve_result result = backend.solve();
+				backend.set_cancellation(own);
+				return result;
+			}
+			catch (...)
+			{
+				backend.set_cancellation(own);
+				throw;
+			}
+		}), token);
+	}
+}
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef __MILPCPP_BACKEND_H__
+#define __MILPCPP_BACKEND_H__
+
+#include<functional>
+#include<memory>
+#include<string>
+#include<vector>
+
+#include<milpcpp/matrix.h>
+#include<milpcpp/model.h>
+#include<milpcpp/progress.h>
+#include<milpcpp/solution_cache.h>
+#include<milpcpp/solve_result.h>
+#include<milpcpp/solver_options.h>
+
+namespace milpcpp
+{
+	// What every solver wrapper shares. solve() builds the model's matrix,
+	// hands it to load() in one piece, lets run() solve it and serves the
+	// values, going through the solution cache when there is one. A backend
+	// only translates the matrix, its options and its results. An attached
+	// backend that loads incrementally gets the columns at attach() and the
+	// streamed rows in batches, so that only the rest is left for solve();
+	// one that does not keeps every streamed row in its matrix until then.
+	class backend : protected row_sink
+	{
+	protected:
+		model * _model;
+		matrix _matrix;					// rows streamed by attach() and not yet in the solver, until solve()
+		bool _attached = false;
+		bool _streaming = false;		// the solver has the columns of _matrix and _loaded_rows rows before its own
+		size_t _loaded_rows = 0;
+		static constexpr size_t stream_batch = 1024;
+		solve_control _control;
+		solve_result _result;
+		solution_cache * _cache = nullptr;
+		cached_solution _solution;
+		std::vector<double> _start;		// MIP start by variable, NaN where not given
+
+		// The start by column, completed and checked against the matrix by
+		// solve(); empty without a usable start
+		std::vector<double> _start_columns;
+		double _start_objective = 0;
+		bool _start_minimize = true;
+
+		std::function<void(matrix&)> _transform;
+		std::vector<basis_status> _warm_rows;	// empty without a warm start
+		std::vector<basis_status> _warm_columns;
+
+		void add_row(const constraint& c) override;
+		void load_streamed_rows();
+		bool update_columns(const matrix& attached);
+
+		virtual solver_options& common_options() = 0;
+
+		// Loads the whole problem; the matrix is released afterwards
+		virtual void load(const matrix& m) = 0;
+
+		// Solves the loaded problem, sets _result and, when there is a
+		// solution, _solution._values by column
+		virtual void run() = 0;
+
+		// Whether the solver takes semi-continuous columns and SOS sets as
+		// they are; solve() linearizes what it does not
+		virtual bool native_semicontinuous() const { return false; }
+		virtual bool native_sos() const { return false; }
+
+		// The final basis, for the cache; leaves both empty by default and
+		// for a MIP, which has no basis worth keeping
+		virtual void get_basis(std::vector<basis_status>& /*rows*/, std::vector<basis_status>& /*columns*/) {}
+
+		// Makes run() start from a basis of the loaded matrix instead of the
+		// solver's own; ignored by default
+		virtual void set_basis(const std::vector<basis_status>& /*rows*/, const std::vector<basis_status>& /*columns*/) {}
+
+		// The duals of the rows after an LP was solved, leaves them empty by
+		// default
+		virtual void get_duals(std::vector<double>& /*rows*/) {}
+
+		// Adds the rows of m from first_row on to the loaded problem, which
+		// has loaded_rows rows, keeping its basis; false when the backend
+		// cannot and m has to be loaded again
+		virtual bool append_rows(const matrix& /*m*/, size_t /*first_row*/, size_t /*loaded_rows*/) { return false; }
+
+		// Replaces the costs, offset and sense of the loaded problem by m's;
+		// false when the backend cannot and m has to be loaded again
+		virtual bool set_objective(const matrix& /*m*/) { return false; }
+
+		// Gives the listed columns of the loaded problem their bounds in m,
+		// keeping its basis; false when the backend cannot
+		virtual bool change_column_bounds(const matrix& /*m*/, const std::vector<int>& /*columns*/) { return false; }
+
+		// Makes the listed columns of the loaded problem integer or
+		// continuous as in m; false when the backend cannot
+		virtual bool change_column_types(const matrix& /*m*/, const std::vector<int>& /*columns*/) { return false; }
+
+		// Whether attach() loads the columns and append_rows() the streamed
+		// rows as they come, set_objective() the objective at solve()
+		virtual bool loads_incrementally() const { return false; }
+
+		void check_start(const matrix& m);
+
+		// Whether the solve ended no worse than the start, as it does when
+		// the solver took it as its first incumbent
+		bool kept_start() const;
+	public:
+		explicit backend(model * m) : _model(m) {}
+		virtual ~backend();
+
+		backend(const backend&) = delete;
+		backend& operator=(const backend&) = delete;
+
+		virtual const char * name() const = 0;
+
+		// Replaces the backend neutral part of the options, leaving the
+		// backend's own settings alone
+		void set_solver_options(const solver_options& o) { common_options() = o; }
+
+		void set_progress_callback(progress_callback f) { _control._progress = f; }
+		// interrupt lets a solver with no hook to stop it, such as the glpk
+		// simplex, split its work to check c; without it c is only checked
+		// at the solver's own callbacks
+		void set_cancellation(const std::optional<cancellation>& c, bool interrupt = true)
+		{
+			_control._cancellation = c;
+			_control._interrupt = c.has_value() && interrupt;
+		}
+		const std::optional<cancellation>& get_cancellation() const { return _control._cancellation; }
+		bool cancelled() const { return _control.cancelled(); }
+
+		// Before loading, solve() looks the model's fingerprint up in the
+		// cache; a hit is returned without loading or solving, an optimal
+		// solution found otherwise is stored with the basis when the backend
+		// has one. Rows must not be streamed.
+		void set_cache(solution_cache * cache) { _cache = cache; }
+
+		// The values and basis of the last solve, or the cache hit
+		const cached_solution& cache_entry() const { return _solution; }
+
+		// Streams each row into the matrix as subject_to generates it, so the
+		// model does not keep its own copy of the constraints, and on into
+		// the solver every stream_batch rows where the backend loads
+		// incrementally. Call after seal_data() and before the constraints
+		// are generated. solve() passes on column bounds and integrality
+		// changed since; other changes to the columns need the rows, which
+		// only a backend that keeps them or has none loaded yet still has.
+		void attach();
+
+		// A known solution for a MIP, e.g. the last one, in the shape
+		// get_values hands them out. Variables without a value start at their
+		// bound nearest to zero. solve() checks the start against bounds,
+		// rows, integrality and SOS sets before passing it to the solver, and
+		// reports in solve_result::_start_accepted whether it was taken. LPs
+		// ignore it.
+		template<typename T>
+		void set_start(const T& vars, const typename T::value_function_t& f)
+		{
+			size_t size = vars.size();
+			size_t start_index = vars.start_index();
+			for (size_t i = 0; i < size; ++i)
+				set_start_value(start_index + i, invoke(i, f));
+		}
+
+		void set_start_value(size_t absolute_index, double value);
+		void clear_start() { _start.clear(); }
+
+		// Changes the matrix solve() builds before it is loaded, e.g. to
+		// solve a part of the model; the columns must stay as they are. The
+		// cache is bypassed while a transform is set.
+		void set_matrix_transform(std::function<void(matrix&)> f) { _transform = std::move(f); }
+
+		// A basis for the next solve() that loads a matrix to start from, by
+		// row and column of that matrix, as get_final_basis hands it out.
+		// It is dropped when the sizes do not match; glpk, highs and cbc use
+		// it for LPs, glpk also for the relaxation of a MIP.
+		void set_warm_start(std::vector<basis_status> rows, std::vector<basis_status> columns)
+		{
+			_warm_rows = std::move(rows);
+			_warm_columns = std::move(columns);
+		}
+
+		// The basis the last solve() ended with, empty when the backend has none
+		void get_final_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns)
+		{
+			rows.clear();
+			columns.clear();
+			get_basis(rows, columns);
+		}
+
+		solve_result solve();
+		const solve_result& result() const { return _result; }
+
+		// Solves m as it is, without the model, its presolve or the cache;
+		// the values by column are in cache_entry(). When the problem loaded
+		// last is m's first loaded_rows rows over the same columns, only the
+		// rows after them are added to it where the backend can, as glpk,
+		// highs and cbc do for LPs. m must not need linearize().
+		solve_result solve(const matrix& m, size_t loaded_rows = 0);
+
+		// Gives the listed columns of the problem solve(m) loaded last their
+		// bounds in m, so that the next solve(m, loaded_rows) can go on with
+		// it; false when the backend cannot (lp_solve, dual_simplex) and m
+		// has to be loaded again
+		bool update_column_bounds(const matrix& m, const std::vector<int>& columns) { return change_column_bounds(m, columns); }
+
+		// For each row, the change of the objective per unit the row's active
+		// bound moves, from the last LP solved; empty for a MIP and from
+		// backends without duals (lp_solve)
+		void get_row_duals(std::vector<double>& rows)
+		{
+			rows.clear();
+			get_duals(rows);
+		}
+
+		double get_variable_value(size_t absolute_index) const;
+
+		template<typename T>
+		void get_values(const T& vars, const typename T::value_iterator_t&f)
+		{
+			size_t size = vars.size();
+			size_t start_index = vars.start_index();
+			for (int i = 0; i < size; ++i)
+			{
+				invoke(i, get_variable_value(start_index + i), f);
+			}
+		}
+
+		// NaN when the solve found no solution
+		double get_objective_value() const;
+	};
+
+	typedef std::function<std::unique_ptr<backend>(model *, const solver_options&)> backend_factory;
+
+	// Makes a backend available to create_backend, replacing any of the same name
+	void register_backend(const std::string& name, backend_factory factory);
+
+	// The backend "auto" stands for: dual_simplex for an LP small enough for
+	// its dense tableau, glpk otherwise. Decided from the rows generated so far.
+	const char * automatic_backend(const model& m);
+
+	// Creates a backend by name: dual_simplex, glpk and lp_solve, highs and
+	// cbc when built with them, "auto" or any registered one. Throws
+	// std::invalid_argument for an unknown name.
+	std::unique_ptr<backend> create_backend(const std::string& name, model * m, const solver_options& o = solver_options());
+
+	std::vector<std::string> backend_names();
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef __MILPCPP_BENDERS_H__
+#define __MILPCPP_BENDERS_H__
+
+#include<algorithm>
+#include<functional>
+#include<memory>
+#include<optional>
+#include<ostream>
+#include<string>
+#include<typeindex>
+#include<vector>
+
+#include<milpcpp/backend.h>
+
+namespace milpcpp
+{
+	struct benders_options
+	{
+		std::string _master_backend = "glpk";		// names for create_backend
+		std::string _subproblem_backend = "glpk";
+		solver_options _solver_options;				// of every backend
+		size_t _threads = 0;						// worker threads for the subproblems, 0 for one per core
+		size_t _iteration_limit = 200;
+		double _gap = 1e-6;							// relative, between the best plan and the bound
+
+		// A lower bound on each scenario's cost, for a minimization; without
+		// one a scenario's cost is left out of the master until its first cut
+		double _recourse_bound = -matrix::infinity;
+	};
+
+	struct benders_report
+	{
+		solve_status _status = solve_status::not_solved;
+		std::optional<double> _objective;	// of the best plan found
+		std::optional<double> _bound;		// from the master, once every scenario has a cut
+		size_t _iterations = 0;
+		size_t _optimality_cuts = 0;
+		size_t _feasibility_cuts = 0;
+		timing _master;						// load and solve of the master
+		timing _subproblems;				// load and solve of the subproblems, summed over threads
+		double _subproblem_wall = 0;		// seconds the rounds of subproblems took
+
+		void write_json(std::ostream& out) const;
+	};
+
+	class worker;
+
+	// Benders decomposition of a two stage model. The first stage variables
+	// go to a master problem; every other variable must be indexed over the
+	// scenario set, whose elements make one LP subproblem each with the
+	// rows using its variables. Rows may only link a scenario to the first
+	// stage. The master gets one cost column per scenario and cuts: an
+	// optimality cut from the duals of a subproblem solved at the master's
+	// plan, a feasibility cut from the duals of its elastic version when
+	// it is infeasible.
+	//
+	// Each round solves the subproblems in parallel, each on a backend of
+	// its own that starts from its last basis, and appends the cuts to the
+	// master, which goes on from its last basis where the backend can. The
+	// model is built once. A first stage with integers makes the master a
+	// MIP. Every scenario is pinned to one of _threads persistent worker
+	// threads, which creates, solves and destroys its backend, so glpk's
+	// per thread environment stays consistent; the subproblem backends must
+	// still be safe to run on several threads at once, and glpk needs to be
+	// built with thread local storage.
+	class benders
+	{
+		struct scenario;
+
+		model * _model;
+		benders_options _options;
+		std::vector<char> _first_stage;		// by variable
+		std::optional<std::type_index> _scenario_set;
+
+		double _sign = 1;					// -1 when the model maximizes, everything here minimizes
+		std::vector<int> _master_columns;	// of the model's matrix, by first stage column of the master
+		matrix _master;
+		std::unique_ptr<backend> _master_backend;
+		std::vector<std::unique_ptr<scenario>> _scenarios;
+		std::vector<std::unique_ptr<worker>> _workers;	// scenario b runs on _workers[b % size]
+		std::vector<double> _values;		// of the best plan, by column of the model's matrix
+		std::optional<double> _objective;
+
+		void build();
+		void release();
+		void for_each_scenario(const std::function<void(size_t)>& job);
+		void solve_scenario(scenario& s, const std::vector<double>& plan);
+	public:
+		benders(model * m, const benders_options& o = benders_options());
+		~benders();
+
+		benders(const benders&) = delete;
+		benders& operator=(const benders&) = delete;
+
+		template<typename T>
+		void add_first_stage(const T& vars)
+		{
+			if (_first_stage.size() < _model->variable_count())
+				_first_stage.resize(_model->variable_count(), 0);
+			std::fill_n(_first_stage.begin() + vars.start_index(), vars.size(), 1);
+		}
+
+		// The set whose elements are the scenarios; without it the set
+		// model::detect_blocks() finds is taken
+		template<typename S>
+		void set_scenarios() { _scenario_set = std::type_index(typeid(S)); }
+
+		void set_options(const benders_options& o) { _options = o; }
+		const benders_options& get_options() const { return _options; }
+
+		// Throws std::logic_error when the model does not split into a first
+		// stage and scenarios, std::invalid_argument for integer variables
+		// in a scenario
+		benders_report solve();
+
+		double get_variable_value(size_t absolute_index) const;
+
+		template<typename T>
+		void get_values(const T& vars, const typename T::value_iterator_t&f)
+		{
+			size_t size = vars.size();
+			size_t start_index = vars.start_index();
+			for (size_t i = 0; i < size; ++i)
+				invoke(i, get_variable_value(start_index + i), f);
+		}
+
+		// NaN when no plan was found
+		double get_objective_value() const;
+	};
+}
+
+#endif
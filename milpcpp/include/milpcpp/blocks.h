@@ -0,0 +1,36 @@
+#ifndef __MILPCPP_BLOCKS_H__
+#define __MILPCPP_BLOCKS_H__
+
+#include<string>
+#include<vector>
+
+namespace milpcpp
+{
+	// A block angular partition of the model's matrix over one index set,
+	// see model::detect_blocks. Block b has the columns of the variables
+	// over element b of the set and the rows using them and no other
+	// block's. Columns of variables not indexed over the set are linking
+	// columns; rows using no block or several are linking rows.
+	struct block_structure
+	{
+		static constexpr int linking = -1;
+
+		std::string _set;					// type_index::name() of the set, empty when none makes blocks
+		size_t _blocks = 0;
+		std::vector<int> _column_block;		// by column of the matrix, or linking
+		std::vector<int> _row_block;		// by row of the matrix, or linking
+		std::vector<std::string> _linking_families;	// subject_to families with a linking row
+
+		bool decomposable() const { return _blocks > 1; }
+		size_t linking_row_count() const;
+		size_t linking_column_count() const;
+
+		// Rows, or columns, of block b from indices[starts[b]] to
+		// indices[starts[b + 1]], in increasing order; the linking ones come
+		// last, as block _blocks
+		void row_partition(std::vector<int>& starts, std::vector<int>& indices) const;
+		void column_partition(std::vector<int>& starts, std::vector<int>& indices) const;
+	};
+}
+
+#endif
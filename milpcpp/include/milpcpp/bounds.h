@@ -1,25 +1,72 @@
 #ifndef __MILPCPP_BOUNDS_H__
 #define __MILPCPP_BOUNDS_H__
 
+#include<functional>
+#include<vector>
+
 #include<milpcpp/expressions.h>
+#include<milpcpp/tuples.h>
 
 namespace milpcpp
 {
+	enum class bound_kind { none, constant, values, callback };
+
+	// Fills the bound of every element at once, in compound index order
+	template<typename ... Ts>
+	struct bulk_bound
+	{
+		std::function<void(std::vector<double>&)> _fill;
+	};
+
+	// A bound is classified when it is declared: a scalar constant, values
+	// filled in bulk at seal_data() (e.g. from a param) or a general callback
+	// evaluated per element.
 	template<bool _Strict = false, typename ... Ts>
 	struct bound : std::function<double(Ts...)>
 	{
+		typedef std::function<double(Ts...)> callback_type;
+
+		bound_kind _kind = bound_kind::none;
+		double _value = 0;
+		std::vector<double> _values;
+		std::function<void(std::vector<double>&)> _fill;
+
 		bound() = default;
 
 		bound(const std::function<expression(Ts...)>&f) :
-			std::function<double(Ts...)>([=](Ts...args) {
+			callback_type([=](Ts...args) {
 			return std::get<expressions::constant>(f(args...))._value;
-		}) {}
+		}), _kind(bound_kind::callback) {}
 
 		bound(const std::function<double(Ts...)>&f) :
-			std::function<double(Ts...)>(f) {}
+			callback_type(f), _kind(bound_kind::callback) {}
 
 		bound(double value) :
-			std::function<double(Ts...)>([=](Ts...) { return value; }) {}
+			_kind(bound_kind::constant), _value(value) {}
+
+		bound(const bulk_bound<Ts...>&b) :
+			_kind(bound_kind::values), _fill(b._fill) {}
+
+		bool defined() const { return _kind != bound_kind::none; }
+
+		void seal()
+		{
+			if (_fill)
+			{
+				_fill(_values);
+				_fill = nullptr;
+			}
+		}
+
+		double get(size_t offset) const
+		{
+			switch (_kind)
+			{
+			case bound_kind::constant: return _value;
+			case bound_kind::values: return _values[offset];
+			default: return invoke(offset, static_cast<const callback_type&>(*this));
+			}
+		}
 	};
 
 
@@ -31,9 +78,11 @@ namespace milpcpp
 		lower_bound(double value) :
 			bound(value) {}
 		lower_bound(const lower_bound<_Strict>&f) :
-			bound([=](Ts...) {return f();  }) {	}
+			bound(f._value) {	}
 		lower_bound(const std::function<expression(Ts...)>&f) :
 			bound(f) {}
+		lower_bound(const bulk_bound<Ts...>&b) :
+			bound(b) {}
 	};
 
 	template<bool _Strict>
@@ -49,8 +98,14 @@ namespace milpcpp
 	{
 		upper_bound() = default;
 
+		upper_bound(double value) :
+			bound(value) {}
+		upper_bound(const upper_bound<_Strict>&f) :
+			bound(f._value) {	}
 		upper_bound(const std::function<expression(Ts...)>&f) :
 			bound(f) {}
+		upper_bound(const bulk_bound<Ts...>&b) :
+			bound(b) {}
 
 	};
 
@@ -0,0 +1,97 @@
+#ifndef __MILPCPP_CBC_H__
+#define __MILPCPP_CBC_H__
+
+#include<memory>
+#include<optional>
+#include<string>
+#include<utility>
+#include<vector>
+
+#include<milpcpp/backend.h>
+
+class OsiClpSolverInterface;
+class CbcModel;
+class CbcObject;
+
+namespace milpcpp
+{
+	// How often CBC runs a cut generator: never, in the whole tree, at the
+	// root only, while the cuts move the bound, or always
+	enum class cut_mode { off, on, root, if_move, force_on };
+
+	// Like HiGHS, CBC presolves unless _presolve is false. Unset values keep
+	// CBC's defaults; anything else CBC's command line accepts can go in
+	// _parameters.
+	struct cbc_options : solver_options
+	{
+		// Branch and cut threads; needs CBC built with --enable-cbc-parallel
+		std::optional<int> _threads;
+
+		std::optional<cut_mode> _cuts;		// every generator, before the settings below
+		std::optional<cut_mode> _gomory;
+		std::optional<cut_mode> _probing;
+		std::optional<cut_mode> _clique;
+		std::optional<cut_mode> _mir;
+		std::optional<cut_mode> _two_mir;
+		std::optional<cut_mode> _flow_cover;
+		std::optional<cut_mode> _knapsack;
+		std::optional<cut_mode> _zero_half;
+
+		std::optional<bool> _heuristics;	// every heuristic, before the settings below
+		std::optional<bool> _feasibility_pump;
+		std::optional<bool> _rins;
+		std::optional<bool> _rens;
+		std::optional<bool> _greedy;
+
+		// Further (name, value) pairs, e.g. { "strategy", "2" }
+		std::vector<std::pair<std::string, std::string>> _parameters;
+	};
+
+	// LPs are solved by CLP, models with integer columns by CBC's branch and
+	// cut as the cbc executable would, with its default cut generators and
+	// heuristics. Progress comes from the CLP and CBC event handlers. With
+	// several threads, CBC calls them from any of its threads, one at a time.
+	//
+	// SOS sets become CbcSOS objects and semi-continuous columns CbcLotsize
+	// objects with the ranges [0, 0] and [lower, upper], so CBC branches on
+	// them directly.
+	class cbc : public backend
+	{
+	public:
+		typedef cbc_options options;
+	private:
+		std::unique_ptr<OsiClpSolverInterface> _solver;
+		std::unique_ptr<CbcModel> _cbc;
+		std::vector<std::unique_ptr<CbcObject>> _objects;	// handed to each CbcModel
+		bool _mip;
+		bool _warm_start;				// set_basis() was called or the LP solved since load()
+		double _objective_offset;		// kept out of the solvers, added to the values they report
+		options _options;
+
+		solver_options& common_options() override { return _options; }
+		void load(const matrix& m) override;
+		void run() override;
+		bool native_semicontinuous() const override { return true; }
+		bool native_sos() const override { return true; }
+		void get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns) override;
+		void set_basis(const std::vector<basis_status>& rows, const std::vector<basis_status>& columns) override;
+		void get_duals(std::vector<double>& rows) override;
+		bool append_rows(const matrix& m, size_t first_row, size_t loaded_rows) override;
+		bool set_objective(const matrix& m) override;
+		bool change_column_bounds(const matrix& m, const std::vector<int>& columns) override;
+		bool change_column_types(const matrix& m, const std::vector<int>& columns) override;
+		bool loads_incrementally() const override { return true; }
+		void solve_lp();
+		void solve_mip();
+	public:
+		cbc(model *m, const options& o = options());
+		~cbc();
+
+		const char * name() const override { return "cbc"; }
+
+		void set_options(const options& o) { _options = o; }
+		const options& get_options() const { return _options; }
+	};
+}
+
+#endif
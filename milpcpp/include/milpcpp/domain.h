@@ -0,0 +1,79 @@
+#ifndef __MILPCPP_DOMAIN_H__
+#define __MILPCPP_DOMAIN_H__
+
+#include<algorithm>
+#include<tuple>
+#include<type_traits>
+#include<utility>
+
+namespace milpcpp
+{
+	// Contiguous run [_begin, _end) of the raw indices of an index type.
+	// In a domain it restricts every argument of that type.
+	template<typename T>
+	struct slice
+	{
+		size_t _begin;
+		size_t _end;
+	};
+
+	template<typename T>
+	inline slice<T> from(const T& first) { return slice<T>{ first.raw_index(), T::size() }; }
+
+	template<typename T>
+	inline slice<T> until(const T& last) { return slice<T>{ 0, last.raw_index() + 1 }; }
+
+	template<typename T>
+	inline slice<T> between(const T& first, const T& last) { return slice<T>{ first.raw_index(), last.raw_index() + 1 }; }
+
+	namespace domains
+	{
+		struct all
+		{
+			template<typename...Ts>
+			bool operator()(const Ts&...) const { return true; }
+		};
+
+		// Bounds of the loop over T: the intersection of the slices on T
+		template<typename T, typename...Ss>
+		std::pair<size_t, size_t> bounds(const std::tuple<slice<Ss>...>& slices)
+		{
+			std::pair<size_t, size_t> result(0, T::size());
+			std::apply([&](const auto&...s) {
+				auto restrict = [&](const auto& s) {
+					if constexpr (std::is_same<std::decay_t<decltype(s)>, slice<T>>::value)
+					{
+						result.first = std::max(result.first, s._begin);
+						result.second = std::min(result.second, s._end);
+					}
+				};
+				(restrict(s), ...);
+			}, slices);
+			return result;
+		}
+	};
+
+	// Index tuples a subject_to or sum iterates over: the slices bound the
+	// loops and the predicate is checked before the lambda is called, so
+	// excluded tuples cost neither a row nor an allocation.
+	template<typename P, typename...Ss>
+	struct domain
+	{
+		P _predicate;
+		std::tuple<slice<Ss>...> _slices;
+	};
+
+	template<typename P, typename...Ss>
+	inline domain<P, Ss...> such_that(P predicate, slice<Ss>...slices)
+	{
+		return domain<P, Ss...>{ predicate, std::make_tuple(slices...) };
+	}
+
+	template<typename...Ss>
+	inline domain<domains::all, Ss...> over(slice<Ss>...slices)
+	{
+		return domain<domains::all, Ss...>{ domains::all(), std::make_tuple(slices...) };
+	}
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef __MILPCPP_DUAL_SIMPLEX_H__
+#define __MILPCPP_DUAL_SIMPLEX_H__
+
+#include<vector>
+
+#include<milpcpp/backend.h>
+
+namespace milpcpp
+{
+	// The built in solver ignores _presolve, _names, _verbose and the
+	// interior point method. pricing_rule::dantzig picks the most infeasible
+	// row, anything else exact dual steepest edge.
+	struct dual_simplex_options : solver_options
+	{
+		double _primal_tolerance = 1e-7;
+		double _dual_tolerance = 1e-7;
+		double _pivot_tolerance = 1e-9;
+
+		// Missing column bounds the dual simplex needs to start are replaced
+		// by +-_box; an optimum with a column on such a bound is unbounded
+		double _box = 1e7;
+	};
+
+	// A bounded dual simplex on a dense tableau, for LPs of a few dozen rows
+	// and columns where setting up glpk costs more than solving. Its
+	// workspace is kept between solves and only grows, so solving a model of
+	// the same size again does not allocate in the simplex. Models with
+	// integer columns are rejected with std::invalid_argument.
+	class dual_simplex : public backend
+	{
+	public:
+		typedef dual_simplex_options options;
+
+		// create_backend("auto", ...) picks this backend for an LP whose
+		// tableau, rows * (rows + columns), has at most that many entries
+		static constexpr size_t tableau_limit = 16384;
+	private:
+		enum class position : char { basic, lower, upper, zero };
+
+		options _options;
+
+		// Columns, then one slack per row: row i reads A_i x - s_i = 0 and
+		// the slack carries the row's bounds
+		size_t _rows = 0;
+		size_t _columns = 0;
+		double _sign = 1;				// -1 when maximizing, the costs are negated
+		double _offset = 0;
+		std::vector<double> _tableau;	// B^-1 [A -I], row major
+		std::vector<double> _lower;
+		std::vector<double> _upper;
+		std::vector<char> _boxed;		// a bound is +-_box
+		std::vector<double> _cost;
+		std::vector<double> _reduced_cost;
+		std::vector<double> _value;
+		std::vector<position> _position;
+		std::vector<int> _head;			// basic variable of each row
+
+		solver_options& common_options() override { return _options; }
+		void load(const matrix& m) override;
+		void run() override;
+		void get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns) override;
+		void get_duals(std::vector<double>& rows) override;
+
+		double& at(size_t row, size_t column) { return _tableau[row * (_columns + _rows) + column]; }
+		int leaving_row() const;
+		int entering_column(int row, bool increase) const;
+		void pivot(int row, int column, double target);
+		void compute_basic_values();
+	public:
+		dual_simplex(model *m, const options& o = options());
+
+		const char * name() const override { return "dual_simplex"; }
+
+		void set_options(const options& o) { _options = o; }
+		const options& get_options() const { return _options; }
+	};
+}
+
+#endif
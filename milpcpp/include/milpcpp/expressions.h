@@ -1,21 +1,26 @@
 #ifndef __MILPCPP_EXPRESSIONS_H__
 #define __MILPCPP_EXPRESSIONS_H__
 
+#include<algorithm>
+#include<cstdint>
 #include<exception>
-#include<map>
 #include<optional>
 #include<string>
 #include<variant>
+#include<vector>
+
+#include<milpcpp/memory.h>
+#include<milpcpp/profiler.h>
 
 namespace milpcpp
 {
 	namespace expressions
 	{
+		// Absolute column index, resolved when the variable is referenced
 		struct variable
 		{
-			size_t _start_index;
-			size_t _offset_index;
-			size_t absolute_index() const { return _start_index + _offset_index;  }
+			uint32_t _index;
+			size_t absolute_index() const { return _index;  }
 		};
 
 		struct constant
@@ -30,10 +35,23 @@ namespace milpcpp
 		};
 
 
+		// Terms are allocated from the resource current when the sum is created
+		// or copied, normally the heap; the model copies a finished row into
+		// its family's arena. They are appended as the sum is built; compact()
+		// sorts them by column and merges duplicates once the row or objective
+		// is complete.
 		struct sum
 		{
-			std::map<size_t, term> _terms;
+			std::pmr::vector<term> _terms;
 			constant _constant_term;
+
+			sum() : _terms(memory::current_resource()) {}
+			sum(const sum& other) :
+				_terms(other._terms, memory::current_resource()), _constant_term(other._constant_term) {}
+			// Keeps the terms in their arena; noexcept so vectors of rows move rather than copy on growth
+			sum(sum&& other) noexcept : _terms(std::move(other._terms)), _constant_term(other._constant_term) {}
+			sum& operator=(const sum&) = default;
+			sum& operator=(sum&&) = default;
 		};
 
 		struct nonlinear_expression : std::logic_error
@@ -44,9 +62,18 @@ namespace milpcpp
 
 	typedef std::variant<std::monostate, expressions::constant, expressions::variable, expressions::term, expressions::sum> expression;
 
+	inline size_t term_count(const expression& e)
+	{
+		if (std::holds_alternative<expressions::sum>(e))
+			return std::get<expressions::sum>(e)._terms.size();
+		if (std::holds_alternative<expressions::term>(e) || std::holds_alternative<expressions::variable>(e))
+			return 1;
+		return 0;
+	}
+
 	inline expression multiply(const expressions::constant&e1, const expressions::constant&e2)
 	{
-		return expressions::constant{ e1._value + e2._value };
+		return expressions::constant{ e1._value * e2._value };
 	}
 
 	inline expression multiply(const expressions::constant&e1, const expressions::variable&e2)
@@ -62,11 +89,12 @@ namespace milpcpp
 	inline expression multiply(const expressions::constant&e1, const expressions::sum&e2)
 	{
 		expressions::sum result;
+		result._terms.reserve(e2._terms.size());
 		for (const auto & term : e2._terms)
 		{
-			result._terms[term.first] = expressions::term{ term.second._variable, e1._value * term.second._coefficient._value };
+			result._terms.push_back(expressions::term{ term._variable, e1._value * term._coefficient._value });
 		}
-		result._constant_term._value *= e1._value;
+		result._constant_term._value = e1._value * e2._constant_term._value;
 		return result;
 	}
 
@@ -96,6 +124,8 @@ namespace milpcpp
 
 	inline expression operator*(const expression&e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::constant>(e1) )
 		{
 			return multiply(std::get<expressions::constant>(e1), e2);
@@ -112,6 +142,8 @@ namespace milpcpp
 
 	inline expression operator/(double e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::constant>(e2))
 		{
 			return expressions::constant{ e1 / std::get<expressions::constant>(e2)._value };
@@ -124,6 +156,8 @@ namespace milpcpp
 
 	inline expression operator/(const expression&e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::constant>(e1) && std::holds_alternative<expressions::constant>(e2))
 		{
 			return expressions::constant{ std::get<expressions::constant>(e2)._value / std::get<expressions::constant>(e2)._value };
@@ -134,112 +168,71 @@ namespace milpcpp
 		}
 	}
 
-	inline void add(expressions::sum& sum, const expression&e)
+	// Appends sign * e to the sum
+	inline void append(expressions::sum& sum, const expression&e, double sign)
 	{
 		if (std::holds_alternative<expressions::constant>(e))
 		{
-			const auto & new_term = std::get<expressions::constant>(e);
-			sum._constant_term._value += new_term._value;
+			sum._constant_term._value += sign * std::get<expressions::constant>(e)._value;
 		}
 		else if (std::holds_alternative<expressions::term>(e))
 		{
 			const auto & new_term = std::get<expressions::term>(e);
-			auto&term = sum._terms.find(new_term._variable.absolute_index());
-			if (term == sum._terms.end())
-			{
-				sum._terms[new_term._variable.absolute_index()] = new_term;
-			}
-			else
-			{
-				term->second._coefficient._value += new_term._coefficient._value;
-			}
+			sum._terms.push_back(expressions::term{ new_term._variable, { sign * new_term._coefficient._value } });
 		}
 		else if (std::holds_alternative<expressions::variable>(e))
 		{
-			const auto & var = std::get<expressions::variable>(e);
-			expressions::term new_term{ {var}, {1} };
-			auto&term = sum._terms.find(new_term._variable.absolute_index());
-			if (term == sum._terms.end())
-			{
-				sum._terms[new_term._variable.absolute_index()] = new_term;
-			}
-			else
-			{
-				term->second._coefficient._value += new_term._coefficient._value;
-			}
+			sum._terms.push_back(expressions::term{ std::get<expressions::variable>(e), { sign } });
 		}
 		else if (std::holds_alternative<expressions::sum>(e))
 		{
 			const auto & other = std::get<expressions::sum>(e);
-			sum._constant_term._value += other._constant_term._value;
+			sum._constant_term._value += sign * other._constant_term._value;
 			for (const auto&term : other._terms)
 			{
-				add(sum, term.second);
+				sum._terms.push_back(expressions::term{ term._variable, { sign * term._coefficient._value } });
 			}
 		}
 		else
 		{
 			throw; //implement later
 		}
-
 	}
 
-	inline void subtract(expressions::sum& sum, const expression&e)
+	inline void add(expressions::sum& sum, const expression&e) { append(sum, e, 1); }
+
+	inline void subtract(expressions::sum& sum, const expression&e) { append(sum, e, -1); }
+
+	inline void compact(expressions::sum& sum)
 	{
-		if (std::holds_alternative<expressions::constant>(e))
-		{
-			const auto & new_term = std::get<expressions::constant>(e);
-			sum._constant_term._value -= new_term._value;
-		}
-		else if (std::holds_alternative<expressions::term>(e))
-		{
-			const auto & new_term = std::get<expressions::term>(e);
-			auto&term = sum._terms.find(new_term._variable.absolute_index());
-			if (term == sum._terms.end())
-			{
-				auto negative = new_term;
-				negative._coefficient._value *= -1;
-				sum._terms[new_term._variable.absolute_index()] = negative;
-			}
+		auto& terms = sum._terms;
+		auto by_column = [](const expressions::term&t1, const expressions::term&t2) { return t1._variable._index < t2._variable._index; };
+		auto unordered = [](const expressions::term&t1, const expressions::term&t2) { return t1._variable._index >= t2._variable._index; };
+		if (std::adjacent_find(terms.begin(), terms.end(), unordered) == terms.end())
+			return;
+
+		std::sort(terms.begin(), terms.end(), by_column);
+		size_t count = 0;
+		for (const auto&term : terms)
+		{
+			if (count > 0 && terms[count - 1]._variable._index == term._variable._index)
+				terms[count - 1]._coefficient._value += term._coefficient._value;
 			else
-			{
-				term->second._coefficient._value -= new_term._coefficient._value;
-			}
-		}
-		else if (std::holds_alternative<expressions::variable>(e))
-		{
-			const auto & var = std::get<expressions::variable>(e);
-			expressions::term new_term{ { var },{ 1 } };
-			auto&term = sum._terms.find(new_term._variable.absolute_index());
-			if (term == sum._terms.end())
-			{
-				auto negative = new_term;
-				negative._coefficient._value *= -1;
-				sum._terms[new_term._variable.absolute_index()] = negative;
-			}
-			else
-			{
-				term->second._coefficient._value -= new_term._coefficient._value;
-			}
-		}
-		else if (std::holds_alternative<expressions::sum>(e))
-		{
-			const auto & other = std::get<expressions::sum>(e);
-			sum._constant_term._value -= other._constant_term._value;
-			for (const auto&term : other._terms)
-			{
-				subtract(sum, term.second);
-			}
-		}
-		else
-		{
-			throw; //implement later
+				terms[count++] = term;
 		}
+		terms.resize(count);
+	}
 
+	inline void compact(expression&e)
+	{
+		if (std::holds_alternative<expressions::sum>(e))
+			compact(std::get<expressions::sum>(e));
 	}
 
 	inline expression operator+(const expression&e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::sum>(e1))
 		{
 			expressions::sum result = std::get<expressions::sum>(e1);
@@ -263,18 +256,14 @@ namespace milpcpp
 
 	inline expression operator-(const expression&e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::sum>(e1))
 		{
 			expressions::sum result = std::get<expressions::sum>(e1);
 			subtract(result, e2);
 			return result;
 		}
-		else if (std::holds_alternative<expressions::sum>(e2))
-		{
-			expressions::sum result = std::get<expressions::sum>(e2);
-			subtract(result, e1);
-			return result;
-		}
 		else
 		{
 			expressions::sum result;
@@ -350,6 +339,8 @@ namespace milpcpp
 
 	inline constraint operator<=(const expression&e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::constant>(e2))
 		{
 			return constraints::upper_bound(e1, std::get<expressions::constant>(e2)._value);
@@ -366,11 +357,15 @@ namespace milpcpp
 
 	inline constraint operator<=(double value, const expression&e)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		return constraints::lower_bound(e, value);
 	}
 
 	inline constraint operator<=(const constraint&e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::constant>(e2))
 		{
 			return constraints::upper_bound(e1, std::get<expressions::constant>(e2)._value);
@@ -383,6 +378,8 @@ namespace milpcpp
 
 	inline constraint operator==(const expression&e1, const expression&e2)
 	{
+		MILPCPP_PROFILE(arithmetic);
+
 		if (std::holds_alternative<expressions::constant>(e2))
 		{
 			return constraints::equal(e1, std::get<expressions::constant>(e2)._value);
@@ -0,0 +1,118 @@
+#ifndef __MILPCPP_FINGERPRINT_H__
+#define __MILPCPP_FINGERPRINT_H__
+
+#include<cstdint>
+#include<cstring>
+#include<functional>
+#include<string>
+
+namespace milpcpp
+{
+	// 128 bit hash of a model's structure: column bounds and kinds, rows,
+	// row bounds, objective and sense. Names are not part of it.
+	struct fingerprint
+	{
+		uint64_t _high = 0;
+		uint64_t _low = 0;
+
+		bool operator==(const fingerprint& other) const { return _high == other._high && _low == other._low; }
+		bool operator!=(const fingerprint& other) const { return !(*this == other); }
+		bool operator<(const fingerprint& other) const { return _high < other._high || (_high == other._high && _low < other._low); }
+
+		std::string to_string() const
+		{
+			static const char digits[] = "0123456789abcdef";
+			std::string result(32, '0');
+			for (int i = 0; i < 16; ++i)
+			{
+				result[15 - i] = digits[(_high >> (4 * i)) & 0xf];
+				result[31 - i] = digits[(_low >> (4 * i)) & 0xf];
+			}
+			return result;
+		}
+	};
+
+	// Streaming MurmurHash3 x64 128 over 64 bit words
+	class hasher
+	{
+		uint64_t _h1 = 0x9e3779b97f4a7c15ull;
+		uint64_t _h2 = 0x6a09e667f3bcc909ull;
+		uint64_t _pending = 0;
+		uint64_t _count = 0;
+
+		static constexpr uint64_t c1 = 0x87c37b91114253d5ull;
+		static constexpr uint64_t c2 = 0x4cf5ad432745937full;
+
+		static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+		static uint64_t fmix(uint64_t k)
+		{
+			k ^= k >> 33;
+			k *= 0xff51afd7ed558ccdull;
+			k ^= k >> 33;
+			k *= 0xc4ceb9fe1a85ec53ull;
+			k ^= k >> 33;
+			return k;
+		}
+
+		void block(uint64_t k1, uint64_t k2)
+		{
+			k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; _h1 ^= k1;
+			_h1 = rotl(_h1, 27); _h1 += _h2; _h1 = _h1 * 5 + 0x52dce729;
+			k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; _h2 ^= k2;
+			_h2 = rotl(_h2, 31); _h2 += _h1; _h2 = _h2 * 5 + 0x38495ab5;
+		}
+	public:
+		void add(uint64_t word)
+		{
+			if (_count++ & 1)
+				block(_pending, word);
+			else
+				_pending = word;
+		}
+
+		// -0.0 and 0.0 hash alike
+		void add(double value)
+		{
+			if (value == 0)
+				value = 0;
+			uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			add(bits);
+		}
+
+		void add(bool value) { add((uint64_t)value); }
+
+		void add(const fingerprint& f)
+		{
+			add(f._high);
+			add(f._low);
+		}
+
+		fingerprint digest() const
+		{
+			uint64_t h1 = _h1, h2 = _h2;
+			if (_count & 1)
+			{
+				uint64_t k1 = _pending * c1;
+				k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+			}
+			h1 ^= _count * 8; h2 ^= _count * 8;
+			h1 += h2; h2 += h1;
+			h1 = fmix(h1); h2 = fmix(h2);
+			h1 += h2; h2 += h1;
+			return fingerprint{ h1, h2 };
+		}
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<milpcpp::fingerprint>
+	{
+		size_t operator()(const milpcpp::fingerprint& f) const { return (size_t)(f._low ^ (f._high * 0x9e3779b97f4a7c15ull)); }
+	};
+}
+
+#endif
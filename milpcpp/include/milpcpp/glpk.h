@@ -1,37 +1,68 @@
 #ifndef __MILPCPP_GLPK_H__
 #define __MILPCPP_GLPK_H__
 
-#include <functional>
+#include <vector>
+
+#include <milpcpp/backend.h>
 
 struct glp_prob;
 
 namespace milpcpp
 {
-	class model;
+	struct glpk_options : solver_options
+	{
+		bool _harris_ratio_test = true;		// GLP_RT_HAR, otherwise the textbook ratio test
+		bool _exact = false;				// refine the simplex solution with glp_exact
+	};
 
-	class glpk
+	// Progress is read from the simplex log lines, which glpk then no longer
+	// prints unless _verbose is set, and from the branch and bound callback.
+	// Both run on the solving thread.
+	//
+	// A cancelled branch and bound stops through glp_ios_terminate. The
+	// simplex has no such hook, so only with a cancellation set to interrupt
+	// (see backend::set_cancellation) it runs in slices of about a quarter
+	// second without the presolver and stops between two slices, keeping the
+	// problem and its basis. Otherwise it runs as configured and a
+	// cancellation is seen once it is done.
+	//
+	// A MIP start is offered through the heuristic hook, at the first node
+	// with a fractional relaxation.
+	//
+	// glpk has neither semi-continuous columns nor SOS sets; they come as
+	// binary columns and rows from matrix::linearize.
+	class glpk : public backend
 	{
-		model * _model;
+	public:
+		typedef glpk_options options;
+	private:
+		enum class solution { basic, interior, mip };
+
 		glp_prob * _lp;
+		options _options;
+		solution _kind;
+		bool _mip;
 
-		double get_variable_value(size_t absolute_index);
+		solver_options& common_options() override { return _options; }
+		void load(const matrix& m) override;
+		void run() override;
+		void get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns) override;
+		void set_basis(const std::vector<basis_status>& rows, const std::vector<basis_status>& columns) override;
+		void get_duals(std::vector<double>& rows) override;
+		bool append_rows(const matrix& m, size_t first_row, size_t loaded_rows) override;
+		bool set_objective(const matrix& m) override;
+		bool change_column_bounds(const matrix& m, const std::vector<int>& columns) override;
+		bool change_column_types(const matrix& m, const std::vector<int>& columns) override;
+		bool loads_incrementally() const override { return true; }
+		void read_values();
 	public:
-		glpk(model *m);
+		glpk(model *m, const options& o = options());
 		~glpk();
-		void solve();
-
-		template<typename T>
-		void get_values(const T& vars, const typename T::value_iterator_t&f)
-		{
-			size_t size = vars.size();
-			size_t start_index = vars.start_index();
-			for (int i = 0; i < size; ++i)
-			{
-				invoke(i, get_variable_value(start_index + i), f);
-			}
-		}
-
-		double get_objective_value();
+
+		const char * name() const override { return "glpk"; }
+
+		void set_options(const options& o) { _options = o; }
+		const options& get_options() const { return _options; }
 	};
 }
 
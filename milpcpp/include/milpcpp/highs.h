@@ -0,0 +1,67 @@
+#ifndef __MILPCPP_HIGHS_H__
+#define __MILPCPP_HIGHS_H__
+
+#include<optional>
+#include<vector>
+
+#include<milpcpp/backend.h>
+
+namespace milpcpp
+{
+	// HiGHS presolves unless _presolve is false, unlike glpk and lp_solve.
+	// simplex_method::dual_then_primal runs the dual simplex; HiGHS switches
+	// to the primal itself when it has to.
+	struct highs_options : solver_options
+	{
+		// Runs the dual simplex on several threads (simplex_strategy PAMI)
+		// and lets the IPM and crossover use them too
+		bool _parallel = false;
+
+		// Size of the HiGHS thread pool. The pool is created by the first
+		// solve of the process, later values are ignored.
+		std::optional<int> _threads;
+
+		std::optional<bool> _crossover;		// after the IPM, on by default
+	};
+
+	// Wraps the HiGHS C API; the matrix is passed in one call, column wise.
+	// Progress and cancellation go through the HiGHS interrupt callbacks of
+	// the simplex, the IPM and the branch and bound; they run on the solving
+	// thread.
+	//
+	// Semi-continuous columns are passed as such; HiGHS has no SOS sets, they
+	// come as binary columns and rows from matrix::linearize.
+	class highs : public backend
+	{
+	public:
+		typedef highs_options options;
+	private:
+		void * _highs;
+		bool _mip;
+		options _options;
+
+		solver_options& common_options() override { return _options; }
+		void load(const matrix& m) override;
+		void run() override;
+		bool native_semicontinuous() const override { return true; }
+		void get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns) override;
+		void set_basis(const std::vector<basis_status>& rows, const std::vector<basis_status>& columns) override;
+		void get_duals(std::vector<double>& rows) override;
+		bool append_rows(const matrix& m, size_t first_row, size_t loaded_rows) override;
+		bool set_objective(const matrix& m) override;
+		bool change_column_bounds(const matrix& m, const std::vector<int>& columns) override;
+		bool change_column_types(const matrix& m, const std::vector<int>& columns) override;
+		bool loads_incrementally() const override { return true; }
+		void apply_options();
+	public:
+		highs(model *m, const options& o = options());
+		~highs();
+
+		const char * name() const override { return "highs"; }
+
+		void set_options(const options& o) { _options = o; }
+		const options& get_options() const { return _options; }
+	};
+}
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef __MILPCPP_INDEXING_H__
 #define __MILPCPP_INDEXING_H__
 
+#include<array>
 #include<exception>
 #include<map>
 #include<string>
+#include<type_traits>
 #include<vector>
 
 namespace milpcpp
@@ -64,6 +66,45 @@ namespace milpcpp
 		template<typename T>
 		index_set * index<T>::_index_set = nullptr;
 
+		// Set whose elements are fixed when it is declared, see MILPCPP_FIXED_SET.
+		// size() is a compile time constant.
+		template<typename T, size_t N>
+		class fixed_index
+		{
+			size_t _raw_index;
+		public:
+			typedef std::string lookup_type;
+
+			constexpr fixed_index(size_t raw_index) : _raw_index(raw_index) {}
+			constexpr size_t raw_index() const { return _raw_index; }
+			static std::array<std::string, N> _names;
+			static constexpr size_t size() { return N; }
+			static size_t index_of(const std::string&name)
+			{
+				for (size_t i = 0; i < N; ++i)
+				{
+					if (_names[i] == name)
+						return i;
+				}
+				throw invalid_index(name);
+			}
+			static std::string name(size_t raw_index) { return _names[raw_index]; }
+			std::string name() const { return name(_raw_index); }
+		};
+
+		template<typename T, size_t N>
+		std::array<std::string, N> fixed_index<T, N>::_names;
+
+		// True when T::size() is a constant expression
+		template<typename T, typename = void>
+		struct has_fixed_size : std::false_type {};
+
+		template<typename T>
+		struct has_fixed_size<T, std::void_t<std::integral_constant<size_t, T::size()>>> : std::true_type {};
+
+		template<typename ... Ts>
+		struct all_fixed : std::bool_constant<(has_fixed_size<Ts>::value && ...)> {};
+
 		template<typename X>
 		struct range_bound
 		{
@@ -76,6 +117,14 @@ namespace milpcpp
 		long range_bound<X>::_value = 0;
 	};
 
+	// Compile time upper bound for range, e.g. range<1, fixed<24>> for the hours of a day
+	template<long N>
+	struct fixed
+	{
+		static constexpr long _value = N;
+		static constexpr long value() { return N; }
+	};
+
 	template<long _Lower, typename _End>
 	class range
 	{
@@ -83,13 +132,13 @@ namespace milpcpp
 	public:
 		typedef long lookup_type;
 
-		range(){ }
-		range(size_t offset) { _offset = offset; }
+		constexpr range(){ }
+		constexpr range(size_t offset) : _offset(offset) { }
 		template<long I, typename T> operator range<I, T>() const { return range<I, T>(_offset + (_Lower - I)); }
 		range<_Lower, _End> operator-(long rhs) const { return range<_Lower, _End>(_offset - rhs); }
 		long name() const { return _Lower + (long)_offset; }
-		static size_t size() { return _End::value() - _Lower + 1; }
-		size_t raw_index() const { return _offset;  }
+		static constexpr size_t size() { return _End::value() - _Lower + 1; }
+		constexpr size_t raw_index() const { return _offset;  }
 		static std::string name(size_t offset) { return std::to_string(_Lower + offset); }
 		static range<_Lower, _End> begin() { return range<_Lower, _End>(0); }
 		static range<_Lower, _End> end() { return range<_Lower, _End>(_End::_value - _Lower + 1); }
@@ -99,6 +148,9 @@ namespace milpcpp
 		static size_t index_of(long index_name) { return index_name - _Lower; }
 	};
 
+	template<long _Lower, long _Upper>
+	using fixed_range = range<_Lower, fixed<_Upper>>;
+
 	template<typename T>
 	inline T first() { return T(0); }
 
@@ -112,6 +164,16 @@ namespace milpcpp
 		return T(index -1); 
 	}
 
+	template<typename T>
+	inline T next(const T&i) { 
+		size_t index = i.raw_index();
+		if (index + 1 >= T::size())
+		{
+			throw indexing::invalid_index("Index already at upper bound!");
+		}
+		return T(index + 1); 
+	}
+
 	template<typename T>
 	inline long ord(const T&i) {
 		size_t index = i.raw_index();
@@ -1,36 +1,54 @@
 #ifndef __MILPCPP_LP_SOLVE_H__
 #define __MILPCPP_LP_SOLVE_H__
 
-#include<functional>
+#include<milpcpp/backend.h>
+
 struct _lprec;
 
 namespace milpcpp
 {
-	class model;
+	// lp_solve has no iteration limit and no interior point method, so
+	// _iteration_limit and lp_algorithm::interior are ignored.
+	struct lp_solve_options : solver_options
+	{
+		std::optional<int> _scaling;		// set_scaling mode, e.g. SCALE_GEOMETRIC + SCALE_DYNUPDATE
+		std::optional<int> _epsilon_level;	// EPS_TIGHT .. EPS_BAGGY
+		std::optional<int> _depth_limit;	// set_bb_depthlimit
+	};
 
-	class lp_solve
+	// Progress is reported on the solving thread when lp_solve finds an
+	// improved LP or MIP solution, and polled from the abort function in
+	// between. Cancellation makes ::solve return USERABORT. lp_solve's basis
+	// is not cached.
+	//
+	// lp_solve has no MIP start. The start's objective becomes the bound
+	// the branch and bound has to beat, and the start is the solution when
+	// nothing better turns up. lp_solve's status is kept, e.g. infeasible
+	// when nothing beat the bound.
+	//
+	// Semi-continuous columns and SOS sets are passed as they are.
+	class lp_solve : public backend
 	{
-		model * _model;
+	public:
+		typedef lp_solve_options options;
+	private:
 		_lprec * _lp;
-		double * _variable_values;
+		options _options;
+
+		solver_options& common_options() override { return _options; }
+		void load(const matrix& m) override;
+		void run() override;
+		bool native_semicontinuous() const override { return true; }
+		bool native_sos() const override { return true; }
+		void apply_options();
 	public:
-		lp_solve(model *m);
+		lp_solve(model *m, const options& o = options());
 		~lp_solve();
-		void solve();
-
-		template<typename T>
-		void get_values(const T& vars, const typename T::value_iterator_t&f)
-		{
-			size_t size = vars.size();
-			size_t start_index = vars.start_index();
-			for (int i = 0; i < size; ++i)
-			{
-				invoke(i, _variable_values[start_index + i], f);
-			}
-		}
 
-		double get_objective_value();
+		const char * name() const override { return "lp_solve"; }
 
+		void set_options(const options& o) { _options = o; }
+		const options& get_options() const { return _options; }
 	};
 }
 
@@ -0,0 +1,72 @@
+#ifndef __MILPCPP_MATRIX_H__
+#define __MILPCPP_MATRIX_H__
+
+#include<limits>
+#include<string>
+#include<vector>
+
+#include<milpcpp/expressions.h>
+
+namespace milpcpp
+{
+	// At most one member of an SOS1 set is nonzero, at most two adjacent
+	// ones of an SOS2 set
+	enum class sos_type : char { sos1 = 1, sos2 = 2 };
+
+	// A model in the form every backend loads: columns with their bounds,
+	// kinds and costs, and the rows in compressed row form. Missing bounds
+	// are infinite; backends map them to their own infinity.
+	struct matrix
+	{
+		static constexpr double infinity = std::numeric_limits<double>::infinity();
+
+		size_t _columns = 0;
+		std::vector<double> _column_lower;
+		std::vector<double> _column_upper;
+		std::vector<double> _cost;
+		std::vector<char> _integer;			// empty for an LP
+		std::vector<char> _semicontinuous;	// empty when there are none
+		std::vector<std::string> _names;	// empty unless asked for
+		double _offset = 0;					// constant of the objective
+		bool _minimize = true;
+
+		std::vector<int> _row_starts{ 0 };
+		std::vector<int> _row_indices;
+		std::vector<double> _row_values;
+		std::vector<double> _row_lower;
+		std::vector<double> _row_upper;
+
+		// Special ordered sets in the same compressed form, the columns of a
+		// set in increasing order of weight
+		std::vector<sos_type> _sos_types;
+		std::vector<int> _sos_starts{ 0 };
+		std::vector<int> _sos_columns;
+		std::vector<double> _sos_weights;
+
+		size_t row_count() const { return _row_lower.size(); }
+		size_t nonzero_count() const { return _row_indices.size(); }
+		bool has_integers() const { return !_integer.empty(); }
+		bool has_semicontinuous() const { return !_semicontinuous.empty(); }
+		size_t sos_count() const { return _sos_types.size(); }
+
+		// Integer or semi-continuous columns or SOS sets, anything that
+		// needs branching
+		bool is_mip() const { return has_integers() || has_semicontinuous() || sos_count() != 0; }
+
+		void add_row(const constraint& c);
+		void clear_rows();
+
+		// Column wise copy of the rows; the row indices of a column come out
+		// in increasing order
+		void to_columns(std::vector<int>& starts, std::vector<int>& indices, std::vector<double>& values) const;
+
+		// Replaces semi-continuous columns, SOS sets or both by binary
+		// columns appended after the others and rows linking them, for a
+		// solver without native support. The members of a set need finite
+		// bounds. A start by column, when not empty, gets the values of the
+		// new columns.
+		void linearize(bool semicontinuous, bool sos, std::vector<double>& start);
+	};
+}
+
+#endif
@@ -1,11 +1,15 @@
 #ifndef __MILPCPP_MILPCPP_H__
 #define __MILPCPP_MILPCPP_H__
 
+#include<tuple>
+
 #include<milpcpp/aggregate.h>
 #include<milpcpp/bounds.h>
+#include<milpcpp/domain.h>
 #include<milpcpp/indexing.h>
 #include<milpcpp/model.h>
 #include<milpcpp/param.h>
+#include<milpcpp/piecewise.h>
 #include<milpcpp/utils.h>
 #include<milpcpp/var.h>
 
@@ -25,6 +29,14 @@ struct X:public milpcpp::indexing::index<X>   \
 milpcpp::indexing::index_set __##X##internal##__ {__VA_ARGS__ };   \
 X::_index_set =  &__##X##internal##__
 
+// Set with a compile time size; its elements are given with the declaration
+#define MILPCPP_FIXED_SET(X, ...) \
+struct X:public milpcpp::indexing::fixed_index<X, std::tuple_size<decltype(std::make_tuple(__VA_ARGS__))>::value>   \
+{   \
+	explicit constexpr X(size_t i):milpcpp::indexing::fixed_index<X, std::tuple_size<decltype(std::make_tuple(__VA_ARGS__))>::value>(i){} \
+};   \
+X::_names = { __VA_ARGS__ }
+
 #define MILPCPP_TYPED_PARAM(X) struct X:public milpcpp::indexing::range_bound<X> { };
 
 #endif
@@ -2,32 +2,104 @@
 #define __MILPCPP_MODEL_H__
 
 #include<algorithm>
+#include<cstdint>
+#include<limits>
+#include<memory>
+#include<optional>
+#include<stdexcept>
 #include<string>
+#include<typeindex>
 #include<vector>
 
+#include<milpcpp/blocks.h>
 #include<milpcpp/bounds.h>
+#include<milpcpp/fingerprint.h>
+#include<milpcpp/indexing.h>
+#include<milpcpp/matrix.h>
+#include<milpcpp/memory.h>
+#include<milpcpp/presolve.h>
+#include<milpcpp/solve_result.h>
 
 namespace milpcpp
 {
 	struct variable_set
 	{
 		size_t _start_index = -100;
+		bool _integer = false;
+		bool _semicontinuous = false;
+		std::optional<sos_type> _sos;
+		size_t _sos_component = 0;		// position of the index the sets run over
 		void set_start_index(size_t index) { _start_index = index; }
 		size_t start_index() const { return  _start_index; }
 		void init();
 
+		// Integer variables make the model a MIP
+		void set_integer(bool integer = true) { _integer = integer; }
+		bool is_integer() const { return _integer; }
+
+		// A semi-continuous variable is 0 or within its bounds, which must
+		// be finite and nonnegative; an integer one is semi-integer
+		void set_semicontinuous(bool semicontinuous = true) { _semicontinuous = semicontinuous; }
+		bool is_semicontinuous() const { return _semicontinuous; }
+
+		// The variables form special ordered sets, see var::set_sos
+		bool has_sos() const { return _sos.has_value(); }
+		sos_type get_sos_type() const { return _sos.value(); }
+		size_t sos_component() const { return _sos_component; }
+		void clear_sos() { _sos.reset(); }
+
+		// The members of one set are stride apart, length of them
+		virtual void get_sos_layout(size_t& stride, size_t& length) const
+		{
+			stride = 1;
+			length = size();
+		}
+
+		// Where the index over a set, by its type, sits in the index of the
+		// variables: the one at offset i is over element i / stride % size.
+		// False unless they are indexed over the set exactly once.
+		virtual bool get_index_layout(std::type_index /*set*/, size_t& /*stride*/, size_t& /*size*/) const { return false; }
+
+		// Appends the sets the variables are indexed over
+		virtual void get_index_sets(std::vector<std::type_index>& /*sets*/) const {}
+
 		virtual size_t size() const = 0;
 		virtual std::string name(size_t absolute_index) const = 0;
 		virtual bool has_lower_bound() const = 0;
 		virtual bool has_upper_bound() const = 0;
 		virtual double get_lower_bound(size_t absolute_index) const = 0;
 		virtual double get_upper_bound(size_t absolute_index) const = 0;
+		virtual void seal() {}
+	};
+
+	// Receives the rows of a model as subject_to generates them
+	class row_sink
+	{
+	public:
+		virtual ~row_sink() {}
+		virtual void add_row(const constraint& c) = 0;
 	};
 
 	class model
 	{
-		friend class glpk;
-		friend class lp_solve;
+		// Rows of a subject_to family are contiguous in _constraints and their
+		// compacted terms are copied into the family's arena. Streamed rows are
+		// not stored.
+		struct constraint_family
+		{
+			std::string _name;
+			std::unique_ptr<memory::arena> _arena;
+			size_t _first_row;
+			size_t _row_count;
+			size_t _nonzero_count;
+			bool _streamed;
+			fingerprint _fingerprint;				// of the first _hashed_rows rows
+			size_t _hashed_rows = size_t(-1);
+		};
+
+		// Declared first so that every expression is destroyed before its arena
+		memory::arena _arena;
+		std::vector<constraint_family> _families;
 
 		std::vector<variable_set*> _variable_sets;
 		std::vector<size_t> _cumulative_sizes;
@@ -37,8 +109,25 @@ namespace milpcpp
 
 		std::vector<constraint> _constraints;
 
+		row_sink * _sink = nullptr;
+		size_t _streamed_rows = 0;
+		size_t _streamed_nonzeros = 0;
+
+		presolve::postsolve_map _postsolve;
+		timing _presolve_timing;
+
+		// Sets are sealed before they are sized, a set may size itself from
+		// the data
 		void index_variable_sets()
 		{
+			for (auto&set : _variable_sets)
+				set->seal();
+			size_t total_size = 0;
+			for (const auto&set : _variable_sets)
+				total_size += set->size();
+			if (total_size > std::numeric_limits<uint32_t>::max())
+				throw std::length_error("Too many variables for 32 bit column indices");
+
 			size_t previous_size = 0;
 			for (auto&set : _variable_sets)
 			{
@@ -55,10 +144,46 @@ namespace milpcpp
 			return it - _cumulative_sizes.begin();
 		}
 
+		// Calls f(set, index) for the variables from first to last, walking
+		// the sets rather than searching each index's
+		template<typename F>
+		void for_each_variable(size_t first, size_t last, F f) const
+		{
+			for (size_t set_index = variable_set_from_absolute_index(first); first < last; ++set_index)
+			{
+				for (size_t end = std::min(last, _cumulative_sizes[set_index]); first < end; ++first)
+					f(*_variable_sets[set_index], first);
+			}
+		}
+
 		static model * _context;
+
+		// Replaces the terms of a compacted row or objective by a copy in a, so
+		// that an arena holds only finished rows and never the temporaries of
+		// the arithmetic that built them
+		static void copy_terms(expression& e, memory::arena * a)
+		{
+			if (a == nullptr || !std::holds_alternative<expressions::sum>(e))
+				return;
+			memory::resource_scope resource(a->resource());
+			expressions::sum copy(std::get<expressions::sum>(e));
+			// emplace move constructs, which keeps the copy in the arena
+			e.emplace<expressions::sum>(std::move(copy));
+		}
 	public:
-		model() { _context = this;  }
-		void seal_data() { index_variable_sets(); }
+		// Expressions are built on the heap; the objective is kept in the
+		// model arena and the rows in their family's
+		model()
+		{ 
+			_context = this;
+		}
+		model(const model&) = delete;
+		model& operator=(const model&) = delete;
+
+		void seal_data() 
+		{ 
+			index_variable_sets(); 
+		}
 		static void add_variable_set(variable_set * var_set)
 		{
 			_context->_variable_sets.push_back(var_set);
@@ -67,44 +192,206 @@ namespace milpcpp
 		static void set_maximixe() { _context->_minimize = false; }
 		static void set_minimize() { _context->_minimize = true; }
 
-		static void set_objective(expression&& e) { _context->_objective = std::move(e); }
-		static void add_constraints(std::vector<constraint>&&c) 
+		static void set_objective(expression&& e) 
 		{ 
-			std::move(c.begin(), c.end(), std::back_inserter(_context->_constraints));
+			compact(e);
+			_context->_objective = std::move(e); 
+			copy_terms(_context->_objective, memory::arenas_enabled() ? &_context->_arena : nullptr);
+		}
+		// Starts a new constraint family. Generating a family again replaces
+		// its rows and releases the previous arena. A streamed family stores
+		// no rows and gets no arena.
+		static void begin_family(const std::string& name)
+		{
+			_context->drop_family(name);
+			bool streamed = _context->_sink != nullptr;
+			std::unique_ptr<memory::arena> arena;
+			if (memory::arenas_enabled() && !streamed)
+				arena = std::make_unique<memory::arena>();
+			_context->_families.push_back(constraint_family{ 
+				name, std::move(arena), _context->_constraints.size(), 0, 0, streamed, fingerprint(), size_t(-1) });
+		}
+
+		static const constraint_family& current_family() { return _context->_families.back(); }
+
+		// null_constraint() rows are dropped here
+		static void add_constraint(constraint&& c)
+		{
+			if (std::holds_alternative<std::monostate>(c._expression) && !c._lower_bound && !c._upper_bound)
+				return;
+			compact(c._expression);
+
+			auto& families = _context->_families;
+			if (families.empty())
+				families.push_back(constraint_family{ std::string(), nullptr, _context->_constraints.size(), 0, 0, _context->_sink != nullptr, fingerprint(), size_t(-1) });
+			auto& family = families.back();
+			size_t nonzeros = term_count(c._expression);
+			++family._row_count;
+			family._nonzero_count += nonzeros;
+
+			if (family._streamed)
+			{
+				_context->_sink->add_row(c);
+				++_context->_streamed_rows;
+				_context->_streamed_nonzeros += nonzeros;
+			}
+			else
+			{
+				copy_terms(c._expression, family._arena.get());
+				_context->_constraints.push_back(std::move(c));
+			}
+		}
+
+		// While a sink is attached subject_to hands each row to it instead of
+		// storing it. Rows stored before attaching are left for the sink's owner.
+		void attach(row_sink * sink)
+		{
+			if (_postsolve.active())
+				throw std::logic_error("Cannot stream rows of a presolved model");
+			_sink = sink;
 		}
+		void detach() { _sink = nullptr; }
+		row_sink * sink() const { return _sink; }
+		bool has_streamed_rows() const { return _streamed_rows != 0; }
 
-		std::string variable_name(size_t absolute_index) const
+		// Removes the rows of a family so that it can be generated again
+		void drop_family(const std::string& name)
 		{
+			auto family = std::find_if(_families.begin(), _families.end(), [&](const auto&f) { return f._name == name; });
+			if (family == _families.end())
+				return;
+			if (family->_streamed)
+				throw std::logic_error("Cannot regenerate streamed constraint family " + name);
+
+			// Move construct the surviving rows so they stay in their own arenas;
+			// erase() would move assign them into the storage of the dropped rows
+			auto first = _constraints.begin() + family->_first_row;
+			auto last = first + family->_row_count;
+			std::vector<constraint> kept;
+			kept.reserve(_constraints.size() - family->_row_count);
+			kept.insert(kept.end(), std::make_move_iterator(_constraints.begin()), std::make_move_iterator(first));
+			kept.insert(kept.end(), std::make_move_iterator(last), std::make_move_iterator(_constraints.end()));
+			_constraints.swap(kept);
+			kept.clear();
+
+			for (auto f = family + 1; f != _families.end(); ++f)
+				f->_first_row -= family->_row_count;
+			_families.erase(family);
+		}
+
+		// Sets the columns and the objective of m and appends the stored
+		// rows after those already streamed into it
+		void load_matrix(matrix& m, bool names) const;
+
+		presolve::statistics presolve();
+		const timing& presolve_timing() const { return _presolve_timing; }
+
+		// The block angular structure of the rows generated so far over the
+		// set S, in one pass over their terms. Families are only named
+		// before presolve(). Throws std::logic_error when rows were streamed.
+		template<typename S>
+		block_structure detect_blocks() const { return detect_blocks(std::type_index(typeid(S))); }
+
+		block_structure detect_blocks(std::type_index set) const;
+
+		// Tries every set a variable is indexed over and keeps the one making
+		// two or more blocks with the fewest linking rows and columns
+		block_structure detect_blocks() const;
+
+		// Hashes the sealed model in parallel chunks of rows and columns. The
+		// digest of a family is kept until it is regenerated, so only new
+		// families are hashed again; bounds and objective always are.
+		fingerprint compute_fingerprint();
+
+		size_t variable_count() const { return _cumulative_sizes.back(); }
+
+		size_t constraint_count() const { return _constraints.size() + _streamed_rows; }
+
+		size_t nonzero_count() const
+		{
+			size_t result = _streamed_nonzeros;
+			for (const auto&c : _constraints)
+				result += term_count(c._expression);
+			return result;
+		}
+
+		size_t column_count() const 
+		{ 
+			return _postsolve.active() ? _postsolve.column_count() : variable_count(); 
+		}
+
+		size_t original_index(size_t column) const
+		{
+			return _postsolve.active() ? _postsolve.original_index(column) : column;
+		}
+
+		size_t column_index(size_t absolute_index) const
+		{
+			return _postsolve.active() ? _postsolve.column_index(absolute_index) : absolute_index;
+		}
+
+		double removed_value(size_t absolute_index) const { return _postsolve.removed_value(absolute_index); }
+
+		std::string variable_name(size_t column) const
+		{
+			size_t absolute_index = original_index(column);
 			size_t var_set_index = variable_set_from_absolute_index(absolute_index);
 			return _variable_sets[var_set_index]->name(absolute_index);
 		}
 
-		bool has_lower_bound(size_t absolute_index) const
+		bool is_integer(size_t column) const
 		{
-			size_t var_set_index = variable_set_from_absolute_index(absolute_index);
+			size_t var_set_index = variable_set_from_absolute_index(original_index(column));
+			return _variable_sets[var_set_index]->is_integer();
+		}
+
+		bool has_integers() const
+		{
+			return std::any_of(_variable_sets.begin(), _variable_sets.end(), [](const auto&set) { return set->is_integer(); });
+		}
+
+		bool has_semicontinuous() const
+		{
+			return std::any_of(_variable_sets.begin(), _variable_sets.end(), [](const auto&set) { return set->is_semicontinuous(); });
+		}
+
+		bool has_sos() const
+		{
+			return std::any_of(_variable_sets.begin(), _variable_sets.end(), [](const auto&set) { return set->has_sos(); });
+		}
+
+		bool has_lower_bound(size_t column) const
+		{
+			if (_postsolve.active())
+				return _postsolve.has_lower_bound(column);
+			size_t var_set_index = variable_set_from_absolute_index(column);
 			return _variable_sets[var_set_index]->has_lower_bound();
 		}
 
-		bool has_upper_bound(size_t absolute_index) const
+		bool has_upper_bound(size_t column) const
 		{
-			size_t var_set_index = variable_set_from_absolute_index(absolute_index);
+			if (_postsolve.active())
+				return _postsolve.has_upper_bound(column);
+			size_t var_set_index = variable_set_from_absolute_index(column);
 			return _variable_sets[var_set_index]->has_upper_bound();
 		}
 
-		double get_lower_bound(size_t absolute_index) const
+		double get_lower_bound(size_t column) const
 		{
-			size_t var_set_index = variable_set_from_absolute_index(absolute_index);
-			return _variable_sets[var_set_index]->get_lower_bound(absolute_index);
+			if (_postsolve.active())
+				return _postsolve.get_lower_bound(column);
+			size_t var_set_index = variable_set_from_absolute_index(column);
+			return _variable_sets[var_set_index]->get_lower_bound(column);
 		}
 
-		double get_upper_bound(size_t absolute_index) const
+		double get_upper_bound(size_t column) const
 		{
-			size_t var_set_index = variable_set_from_absolute_index(absolute_index);
-			return _variable_sets[var_set_index]->get_upper_bound(absolute_index);
+			if (_postsolve.active())
+				return _postsolve.get_upper_bound(column);
+			size_t var_set_index = variable_set_from_absolute_index(column);
+			return _variable_sets[var_set_index]->get_upper_bound(column);
 		}
 
-		size_t variable_count() const { return _cumulative_sizes.back(); }
-
 	};
 
 	inline void variable_set::init() { model::add_variable_set(this); }
@@ -1,6 +1,11 @@
 #ifndef __MILPCPP_PARAM_H__
 #define __MILPCPP_PARAM_H__
 
+#include<algorithm>
+#include<array>
+#include<iterator>
+#include<stdexcept>
+#include<type_traits>
 #include<vector>
 
 #include<milpcpp/bounds.h>
@@ -8,23 +13,81 @@
 
 namespace milpcpp
 {
+	// std::array backed storage for params over fixed size sets, with the
+	// subset of the std::vector interface param uses
+	template<size_t N>
+	class fixed_values
+	{
+		std::array<double, N> _values{};
+		size_t _size = 0;
+	public:
+		bool empty() const { return _size == 0; }
+		void resize(size_t size) { _size = size; }
+		double * end() { return _values.data() + _size; }
+		double& operator[](size_t index) { return _values[index]; }
+		const double& operator[](size_t index) const { return _values[index]; }
+
+		template<typename It>
+		void insert(double *, It first, It last)
+		{
+			if (_size + (size_t)std::distance(first, last) > N)
+				throw std::length_error("Too many values for fixed size param");
+			_size = std::copy(first, last, end()) - _values.data();
+		}
+	};
+
+	// Values kept inline at most, larger fixed size params go to the heap
+	// like the others since params are often on the stack
+	constexpr size_t max_inline_values = 512;
+
+	template<bool Fixed, typename ... Ts>
+	struct param_storage
+	{
+		typedef std::vector<double> type;
+	};
+
+	template<typename ... Ts>
+	struct param_storage<true, Ts...>
+	{
+		static constexpr size_t size = compound_index<Ts...>::size();
+
+		typedef std::conditional_t<(size <= max_inline_values),
+			fixed_values<size>, std::vector<double>> type;
+	};
+
+	template<typename ... Ts>
+	using param_storage_t = typename param_storage<indexing::all_fixed<Ts...>::value, Ts...>::type;
+
+	template<typename Values = std::vector<double>>
 	class indexed_param
 	{
 	protected:
 		double _default{};
-		std::vector<double> _values;
+		Values _values;
 	public:
 		void set_default(double d) { _default = d;  }
+
+		// All values in compound index order, the default where none were given
+		void copy_values(std::vector<double>&values, size_t size) const
+		{
+			values.assign(size, _default);
+			if (_values.empty())
+				return;
+			for (size_t i = 0; i < size; ++i)
+				values[i] = _values[i];
+		}
 	};
 
 	template<typename T1 = void, typename ... Ts>
-	class param : public indexed_param
+	class param : public indexed_param<param_storage_t<T1, Ts...>>
 	{
+		stride_table<T1, Ts...> _strides;	// of the values, set when they are laid out
 	public:
 		typedef typename param<Ts...>::list_element_t list_element_t2;
 		typedef std::initializer_list<list_element_t2> list_element_t;
 
-		static void initialize_values(std::vector<double>&values, std::initializer_list<list_element_t> list)
+		template<typename Values>
+		static void initialize_values(Values&values, std::initializer_list<list_element_t> list)
 		{
 			for (const auto&l : list)
 			{
@@ -34,7 +97,8 @@ namespace milpcpp
 
 		param(std::initializer_list<list_element_t> list)
 		{
-			initialize_values(_values, list);
+			initialize_values(this->_values, list);
+			_strides.seal();
 		}
 
 		param() = default;
@@ -45,35 +109,37 @@ namespace milpcpp
 
 		expression operator()(T1 arg1, Ts...args)
 		{
-			if (_values.empty())
-				return expressions::constant{ _default };
-			return expressions::constant{ _values[get_offset(arg1, args...)] };
+			if (this->_values.empty())
+				return expressions::constant{ this->_default };
+			return expressions::constant{ this->_values[_strides.offset(arg1, args...)] };
 		}
 
 		void add(const typename T1::lookup_type&arg1, const typename Ts::lookup_type&...args , double value)
 		{
-			if (_values.empty())
+			if (this->_values.empty())
 			{
-				_values.resize(compound_index<T1, Ts...>::size());
+				_strides.seal();
+				this->_values.resize(_strides._size);
 			}
-			_values[get_offset_by_lookup<T1, Ts...>(arg1, args...)] = value;
+			this->_values[_strides.offset({ T1::index_of(arg1), Ts::index_of(args)... })] = value;
 		}
 	};
 
 	template<typename T>
-	class param<T> : public indexed_param
+	class param<T> : public indexed_param<param_storage_t<T>>
 	{
 	public:
 		typedef double list_element_t;
 		
-		static void initialize_values(std::vector<double>&values, std::initializer_list<list_element_t> list)
+		template<typename Values>
+		static void initialize_values(Values&values, std::initializer_list<list_element_t> list)
 		{
 			values.insert(values.end(), list.begin(), list.end());
 		}
 
 		param(std::initializer_list<list_element_t> list)
 		{
-			initialize_values(_values, list);
+			initialize_values(this->_values, list);
 		}
 
 		param() = default;
@@ -84,18 +150,18 @@ namespace milpcpp
 
 		expression operator()(T arg)
 		{
-			if (_values.empty())
-				return expressions::constant{ _default };
-			return expressions::constant{ _values[get_offset(arg)] };
+			if (this->_values.empty())
+				return expressions::constant{ this->_default };
+			return expressions::constant{ this->_values[get_offset(arg)] };
 		}
 
 		void add(const typename T::lookup_type&arg, double value)
 		{
-			if (_values.empty())
+			if (this->_values.empty())
 			{
-				_values.resize(compound_index<T>::size());
+				this->_values.resize(compound_index<T>::size());
 			}
-			_values[get_offset_by_lookup<T>(arg)] = value;
+			this->_values[get_offset_by_lookup<T>(arg)] = value;
 		}
 	};
 
@@ -117,7 +183,22 @@ namespace milpcpp
 		double operator=(double value) { return _value = value;  }
 	};
 
+	// Param backed var bounds, copied in bulk when the model is sealed
+	template<typename T1, typename ... Ts>
+	inline lower_bound<false, T1, Ts...> greater_equal(const param<T1, Ts...>&p)
+	{
+		return bulk_bound<T1, Ts...>{ [&p](std::vector<double>&values) {
+			p.copy_values(values, compound_index<T1, Ts...>::size());
+		} };
+	}
 
+	template<typename T1, typename ... Ts>
+	inline upper_bound<false, T1, Ts...> less_equal(const param<T1, Ts...>&p)
+	{
+		return bulk_bound<T1, Ts...>{ [&p](std::vector<double>&values) {
+			p.copy_values(values, compound_index<T1, Ts...>::size());
+		} };
+	}
 }
 
 
@@ -0,0 +1,262 @@
+#ifndef __MILPCPP_PIECEWISE_H__
+#define __MILPCPP_PIECEWISE_H__
+
+#include<algorithm>
+#include<array>
+#include<cmath>
+#include<limits>
+#include<stdexcept>
+#include<string>
+#include<typeindex>
+#include<vector>
+
+#include<milpcpp/aggregate.h>
+#include<milpcpp/model.h>
+#include<milpcpp/param.h>
+#include<milpcpp/tuples.h>
+
+namespace milpcpp
+{
+	// How a piecewise linear term is written with linear rows. lp needs a
+	// function convex in the objective direction, the cheap segments then
+	// fill first by themselves. incremental adds a binary per inner
+	// breakpoint, sos2 weights the breakpoints with an SOS2 set, which
+	// lp_solve and CBC branch on natively. automatic picks lp when it can
+	// and incremental otherwise.
+	enum class piecewise_encoding { automatic, lp, incremental, sos2 };
+
+	// AMPL's <<breakpoints; slopes>> x for every element of Ts..., over the
+	// segments K: the function is 0 at 0 and has slope(t, k) between
+	// breakpoint(t, k - 1), 0 for the first segment, and breakpoint(t, k).
+	// The argument ranges over [0, last breakpoint]; the last breakpoint may
+	// be infinite with the lp encoding, as AMPL's missing one is.
+	//
+	// The segment columns are declared with the piecewise, before
+	// seal_data(), and sized from the params then. link() generates the rows
+	// tying each argument to its segments; piecewise(t) is the function's
+	// value, to be used in the objective.
+	template<typename K, typename ... Ts>
+	class piecewise
+	{
+		static_assert(sizeof...(Ts) > 0, "A piecewise term is indexed over at least one set");
+
+		// The segment amounts, or the breakpoint weights for sos2, and the
+		// binaries of the incremental encoding, in blocks of per_element
+		// columns for each element of Ts...
+		struct columns : variable_set
+		{
+			piecewise * _owner;
+			bool _amounts;
+
+			columns(piecewise * owner, bool amounts) : _owner(owner), _amounts(amounts) { init(); }
+
+			size_t per_element() const { return _amounts ? _owner->_amount_count : _owner->_switch_count; }
+			size_t size() const override { return compound_index<Ts...>::size() * per_element(); }
+
+			std::string name(size_t absolute_index) const override
+			{
+				size_t offset = absolute_index - _start_index;
+				size_t element = offset / per_element(), k = offset % per_element();
+				std::string segment = _owner->_encoding != piecewise_encoding::sos2 ? K::name(k) :
+					k == 0 ? std::string("0") : K::name(k - 1);
+				return compound_index<Ts...>::name(element) + "," + segment;
+			}
+
+			bool has_lower_bound() const override { return true; }
+			bool has_upper_bound() const override { return true; }
+			double get_lower_bound(size_t absolute_index) const override { return 0; }
+			double get_upper_bound(size_t absolute_index) const override
+			{
+				if (!_amounts || _owner->_encoding == piecewise_encoding::sos2)
+					return 1;
+				size_t offset = absolute_index - _start_index;
+				return _owner->length(offset / per_element(), offset % per_element());
+			}
+
+			void get_sos_layout(size_t& stride, size_t& length) const override
+			{
+				stride = 1;
+				length = per_element();
+			}
+
+			bool get_index_layout(std::type_index set, size_t& stride, size_t& size) const override
+			{
+				std::array<std::type_index, sizeof...(Ts)> sets{ std::type_index(typeid(Ts))... };
+				if (std::count(sets.begin(), sets.end(), set) != 1)
+					return false;
+				size_t component = std::find(sets.begin(), sets.end(), set) - sets.begin();
+				std::array<size_t, sizeof...(Ts)> sizes{ Ts::size()... };
+				stride = get_strides<Ts...>()[component] * per_element();
+				size = sizes[component];
+				return true;
+			}
+
+			void get_index_sets(std::vector<std::type_index>& sets) const override
+			{
+				(sets.push_back(typeid(Ts)), ...);
+			}
+
+			void seal() override
+			{
+				if (_amounts)
+					_owner->prepare();
+			}
+		};
+
+		const param<Ts..., K>& _breakpoints_param;
+		const param<Ts..., K>& _slopes_param;
+		piecewise_encoding _encoding;
+		bool _maximized;
+
+		std::vector<double> _breakpoints;	// by element, then segment
+		std::vector<double> _slopes;
+		size_t _segments = 0;
+		size_t _amount_count = 0;
+		size_t _switch_count = 0;
+
+		columns _amounts{ this, true };
+		columns _switches{ this, false };
+		stride_table<Ts...> _strides;		// of the elements, set at seal
+
+		double breakpoint(size_t element, size_t k) const { return _breakpoints[element * _segments + k]; }
+		double length(size_t element, size_t k) const { return breakpoint(element, k) - (k == 0 ? 0 : breakpoint(element, k - 1)); }
+
+		size_t amount(size_t element, size_t k) const { return _amounts.start_index() + element * _amount_count + k; }
+		size_t switch_column(size_t element, size_t k) const { return _switches.start_index() + element * _switch_count + k; }
+
+		static void add_term(expressions::sum& sum, size_t column, double coefficient)
+		{
+			sum._terms.push_back(expressions::term{ expressions::variable{ (uint32_t)column }, expressions::constant{ coefficient } });
+		}
+
+		// Reads the params and picks the encoding; the sizes of both column
+		// sets follow from it
+		void prepare()
+		{
+			_strides.seal();
+			size_t elements = compound_index<Ts...>::size();
+			_segments = K::size();
+			if (_segments == 0)
+				throw std::logic_error("A piecewise term needs at least one segment");
+			_breakpoints_param.copy_values(_breakpoints, elements * _segments);
+			_slopes_param.copy_values(_slopes, elements * _segments);
+
+			bool convex = true, bounded = true;
+			for (size_t t = 0; t < elements; ++t)
+			{
+				for (size_t k = 0; k < _segments; ++k)
+				{
+					if (!(length(t, k) > 0))
+						throw std::logic_error("Breakpoints of a piecewise term must increase from 0");
+					double step = k == 0 ? 0 : _slopes[t * _segments + k] - _slopes[t * _segments + k - 1];
+					convex = convex && (_maximized ? step <= 0 : step >= 0);
+				}
+				bounded = bounded && std::isfinite(breakpoint(t, _segments - 1));
+			}
+
+			if (_encoding == piecewise_encoding::automatic)
+				_encoding = convex ? piecewise_encoding::lp : piecewise_encoding::incremental;
+			if (_encoding == piecewise_encoding::lp && !convex)
+				throw std::logic_error("The lp encoding needs a piecewise term convex in the objective direction");
+			if (_encoding != piecewise_encoding::lp && !bounded)
+				throw std::logic_error("A nonconvex piecewise term needs a finite last breakpoint");
+
+			_amount_count = _encoding == piecewise_encoding::sos2 ? _segments + 1 : _segments;
+			_switch_count = _encoding == piecewise_encoding::incremental ? _segments - 1 : 0;
+			_switches.set_integer(_switch_count != 0);
+			if (_encoding == piecewise_encoding::sos2)
+				_amounts._sos = sos_type::sos2;
+		}
+	public:
+		// maximized tells automatic that the term is a profit
+		piecewise(const param<Ts..., K>& breakpoints, const param<Ts..., K>& slopes,
+			piecewise_encoding encoding = piecewise_encoding::automatic, bool maximized = false) :
+			_breakpoints_param(breakpoints), _slopes_param(slopes), _encoding(encoding), _maximized(maximized) {}
+
+		piecewise(const piecewise&) = delete;
+		piecewise& operator=(const piecewise&) = delete;
+
+		// The encoding chosen at seal_data()
+		piecewise_encoding encoding() const { return _encoding; }
+
+		// Generates, over all of Ts..., the family name tying argument(t) to
+		// the columns of t, and for the incremental and sos2 encodings the
+		// families name_fill and name_gate, or name_convex
+		template<typename F>
+		void link(const std::string& name, const F& argument)
+		{
+			subject_to(name.c_str(), [&](Ts...args) {
+				size_t element = _strides.offset(args...);
+				expressions::sum row;
+				add(row, argument(args...));
+				for (size_t k = 0; k < _amount_count; ++k)
+				{
+					double coefficient = _encoding != piecewise_encoding::sos2 ? 1 :
+						k == 0 ? 0 : breakpoint(element, k - 1);
+					if (coefficient != 0)
+						add_term(row, amount(element, k), -coefficient);
+				}
+				return constraints::equal(std::move(row), 0);
+			});
+
+			if (_encoding == piecewise_encoding::sos2)
+			{
+				subject_to((name + "_convex").c_str(), [&](Ts...args) {
+					size_t element = _strides.offset(args...);
+					expressions::sum row;
+					for (size_t k = 0; k < _amount_count; ++k)
+						add_term(row, amount(element, k), 1);
+					return constraints::equal(std::move(row), 1);
+				});
+			}
+			if (_encoding != piecewise_encoding::incremental)
+				return;
+
+			// Switch k is 1 when segment k is full, and segment k + 1 may
+			// only be used then
+			subject_to((name + "_fill").c_str(), [&](Ts...args, K k) {
+				size_t element = _strides.offset(args...);
+				if (k.raw_index() + 1 == _segments)
+					return null_constraint();
+				expressions::sum row;
+				add_term(row, amount(element, k.raw_index()), 1);
+				add_term(row, switch_column(element, k.raw_index()), -length(element, k.raw_index()));
+				return constraints::lower_bound(std::move(row), 0);
+			});
+			subject_to((name + "_gate").c_str(), [&](Ts...args, K k) {
+				size_t element = _strides.offset(args...);
+				if (k.raw_index() + 1 == _segments)
+					return null_constraint();
+				expressions::sum row;
+				add_term(row, amount(element, k.raw_index() + 1), 1);
+				add_term(row, switch_column(element, k.raw_index()), -length(element, k.raw_index() + 1));
+				return constraints::upper_bound(std::move(row), 0);
+			});
+		}
+
+		// The value of the function at the argument of t
+		expression operator()(Ts...args) const
+		{
+			size_t element = _strides.offset(args...);
+			expressions::sum result;
+			double value = 0;
+			for (size_t k = 0; k < _amount_count; ++k)
+			{
+				double coefficient;
+				if (_encoding == piecewise_encoding::sos2)
+				{
+					coefficient = value;
+					if (k < _segments)
+						value += _slopes[element * _segments + k] * length(element, k);
+				}
+				else
+					coefficient = _slopes[element * _segments + k];
+				if (coefficient != 0)
+					add_term(result, amount(element, k), coefficient);
+			}
+			return result;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef __MILPCPP_PIPELINE_H__
+#define __MILPCPP_PIPELINE_H__
+
+#include<exception>
+#include<memory>
+#include<optional>
+#include<vector>
+
+#include<milpcpp/model.h>
+#include<milpcpp/worker.h>
+
+namespace milpcpp
+{
+	// Loads rows into a backend on a loader thread while subject_to keeps
+	// generating. Rows are copied to the heap, batched and handed over
+	// through a bounded queue; a full queue blocks the generating thread,
+	// which caps the rows in flight at max_batches * batch_rows. glpk, highs
+	// and cbc load incrementally, so the loader thread passes the rows on
+	// into the solver and solve() only adds the objective and the last
+	// rows; other backends just build their matrix there and load it in
+	// solve().
+	//
+	// glpk keeps its memory in a per thread environment, so everything that
+	// touches the backend runs on the loader thread: the pipeline constructs,
+	// attaches, solves and destroys it there, and run() executes anything
+	// else. Create the pipeline after seal_data() and before the first
+	// subject_to; rows generated earlier are loaded by solve().
+	template<typename Backend>
+	class pipeline : row_sink
+	{
+		model * _model;
+		size_t _batch_rows;
+		std::optional<Backend> _backend;
+		row_sink * _loader = nullptr;		// the backend's own sink
+		std::vector<constraint> _batch;
+		std::exception_ptr _error;			// first exception of a batch
+
+		// Declared last, so that its thread is joined before the rest goes
+		worker _loader_thread;			// holds at most max_batches tasks
+
+		void flush()
+		{
+			if (_batch.empty())
+				return;
+			auto batch = std::make_shared<std::vector<constraint>>(std::move(_batch));
+			_batch = std::vector<constraint>();
+			_batch.reserve(_batch_rows);
+			_loader_thread.post([this, batch]() {
+				if (_error)
+					return;
+				try
+				{
+					for (const auto& c : *batch)
+						_loader->add_row(c);
+				}
+				catch (...)
+				{
+					_error = std::current_exception();
+				}
+				// the rows were copied on the heap; free them here, off the generating thread
+				batch->clear();
+			});
+		}
+
+		// Runs f on the loader thread after the queued rows and waits for it
+		template<typename F>
+		auto call(F f) -> decltype(f())
+		{
+			flush();
+			return _loader_thread.submit(f).get();
+		}
+
+		void add_row(const constraint& c) override
+		{
+			_batch.push_back(c);
+			if (_batch.size() >= _batch_rows)
+				flush();
+		}
+	public:
+		pipeline(model * m, const typename Backend::options& o = typename Backend::options(),
+			size_t batch_rows = 4096, size_t max_batches = 8) :
+			_model(m), _batch_rows(batch_rows), _loader_thread(max_batches)
+		{
+			_batch.reserve(_batch_rows);
+			try
+			{
+				call([&]() {
+					_backend.emplace(m, o);
+					_backend->attach();
+				});
+			}
+			catch (...)
+			{
+				call([this]() { _backend.reset(); });
+				throw;
+			}
+			_loader = _model->sink();
+			_model->attach(this);
+		}
+
+		~pipeline()
+		{
+			if (_model->sink() == this)
+				_model->detach();
+			call([this]() { _backend.reset(); });
+		}
+
+		pipeline(const pipeline&) = delete;
+		pipeline& operator=(const pipeline&) = delete;
+
+		// Runs f(backend) on the loader thread after the rows queued so far
+		// and returns its result, e.g. to read values after solve()
+		template<typename F>
+		auto run(F f) -> decltype(f(std::declval<Backend&>()))
+		{
+			return call([&]() { return f(*_backend); });
+		}
+
+		// Waits for the queued rows, then solves on the loader thread; the
+		// first exception a batch threw is rethrown instead
+		solve_result solve()
+		{
+			flush();
+			if (_model->sink() == this)
+				_model->detach();
+			return run([this](Backend& b) {
+				if (_error)
+					std::rethrow_exception(_error);
+				return b.solve();
+			});
+		}
+
+		template<typename T>
+		void get_values(const T& vars, const typename T::value_iterator_t& f)
+		{
+			run([&](Backend& b) { b.get_values(vars, f); });
+		}
+
+		double get_objective_value() { return run([](Backend& b) { return b.get_objective_value(); }); }
+
+		// Time subject_to spent waiting for a free slot in the queue
+		double blocked_time() const { return _loader_thread.blocked_time(); }
+	};
+}
+
+#endif
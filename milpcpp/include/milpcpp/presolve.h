@@ -0,0 +1,66 @@
+#ifndef __MILPCPP_PRESOLVE_H__
+#define __MILPCPP_PRESOLVE_H__
+
+#include<cmath>
+#include<stdexcept>
+#include<string>
+#include<vector>
+
+namespace milpcpp
+{
+	namespace presolve
+	{
+		struct infeasible_model : std::runtime_error
+		{
+			infeasible_model(const std::string& what) : std::runtime_error(what) {}
+		};
+
+		struct statistics
+		{
+			size_t _rows_removed = 0;
+			size_t _columns_removed = 0;
+			size_t _bounds_tightened = 0;
+		};
+
+		// Maps the columns handed to a backend back to the model's variables.
+		// Until model::presolve() runs, the map is the identity.
+		class postsolve_map
+		{
+			std::vector<size_t> _original_index;	// column -> absolute index
+			std::vector<size_t> _column_index;		// absolute index -> column or removed
+			std::vector<double> _values;			// absolute index -> value of a removed variable
+			std::vector<double> _lower_bounds;		// column -> lower bound, -inf when none
+			std::vector<double> _upper_bounds;		// column -> upper bound, +inf when none
+		public:
+			static constexpr size_t removed = size_t(-1);
+
+			postsolve_map() = default;
+			postsolve_map(size_t variable_count) :
+				_column_index(variable_count, removed), _values(variable_count) {}
+
+			bool active() const { return !_column_index.empty(); }
+
+			void keep(size_t absolute_index, double lower, double upper)
+			{
+				_column_index[absolute_index] = _original_index.size();
+				_original_index.push_back(absolute_index);
+				_lower_bounds.push_back(lower);
+				_upper_bounds.push_back(upper);
+			}
+			void remove(size_t absolute_index, double value) { _values[absolute_index] = value; }
+
+			size_t column_count() const { return _original_index.size(); }
+			size_t original_index(size_t column) const { return _original_index[column]; }
+			size_t column_index(size_t absolute_index) const { return _column_index[absolute_index]; }
+			bool is_removed(size_t absolute_index) const { return _column_index[absolute_index] == removed; }
+			double removed_value(size_t absolute_index) const { return _values[absolute_index]; }
+
+			bool has_lower_bound(size_t column) const { return std::isfinite(_lower_bounds[column]); }
+			bool has_upper_bound(size_t column) const { return std::isfinite(_upper_bounds[column]); }
+			double get_lower_bound(size_t column) const { return _lower_bounds[column]; }
+			double get_upper_bound(size_t column) const { return _upper_bounds[column]; }
+		};
+	};
+}
+
+#endif
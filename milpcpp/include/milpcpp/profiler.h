@@ -0,0 +1,147 @@
+#ifndef __MILPCPP_PROFILER_H__
+#define __MILPCPP_PROFILER_H__
+
+#include<array>
+#include<chrono>
+#include<deque>
+#include<mutex>
+#include<ostream>
+#include<string>
+#include<vector>
+
+namespace milpcpp
+{
+	namespace profiling
+	{
+		enum class category { lambda, arithmetic, container, load, solve, count };
+
+		enum class family_kind { constraints, objective, backend, unattributed };
+
+		typedef std::chrono::steady_clock clock;
+
+		class scope;
+
+		struct family_statistics
+		{
+			std::string _name;
+			family_kind _kind = family_kind::unattributed;
+			size_t _rows = 0;
+			size_t _nonzeros = 0;
+			size_t _bytes_allocated = 0;
+			double _total_time = 0;
+			std::array<double, (size_t)category::count> _times{};	// self time, seconds
+
+			double time(category c) const { return _times[(size_t)c]; }
+		};
+
+		struct trace_event
+		{
+			std::string _name;
+			family_kind _kind;
+			double _start;		// microseconds since the profiler was created
+			double _duration;
+			size_t _thread;
+		};
+
+		// Bytes allocated by the calling thread; only counted when the library
+		// is built with MILPCPP_COUNT_ALLOCATIONS, zero otherwise.
+		size_t allocated_bytes();
+
+		// Collects per family statistics while a model is generated and solved.
+		// Like model, the most recently created profiler is the active one.
+		class profiler
+		{
+			friend class family_scope;
+			friend class scope;
+
+			// Work outside any family, one entry per thread that did some; a
+			// thread adds to its own entry without the lock, the reports merge
+			// them under it
+			struct thread_statistics
+			{
+				family_statistics _statistics;
+				size_t _start_bytes;	// the thread's allocation count when _statistics was last reset
+			};
+
+			mutable std::mutex _mutex;
+			std::deque<family_statistics> _families;
+			std::vector<trace_event> _events;
+			std::deque<thread_statistics> _unattributed;
+			bool _trace = false;
+			clock::time_point _start = clock::now();
+			size_t _id;								// tells apart profilers created at the same address
+
+			static profiler * _context;
+			static thread_local thread_statistics * _thread_unattributed;
+			static thread_local size_t _thread_owner;	// _id of the profiler _thread_unattributed belongs to
+
+			thread_statistics& unattributed();		// the calling thread's
+			family_statistics merged_unattributed() const;
+		public:
+			profiler();
+			~profiler() { if (_context == this) _context = nullptr; }
+			profiler(const profiler&) = delete;
+			profiler& operator=(const profiler&) = delete;
+
+			static profiler * current() { return _context; }
+
+			void enable_trace(bool enable = true) { _trace = enable; }
+
+			const std::deque<family_statistics>& families() const { return _families; }
+
+			// The objective expression is built before maximize()/minimize() is entered,
+			// so the generation work done outside any family is credited to the objective.
+			void add_objective(const std::string& name, size_t nonzeros);
+
+			void write_json(std::ostream& out) const;
+			void write_csv(std::ostream& out) const;
+			void write_chrome_trace(std::ostream& out) const;
+		};
+
+		// Times a subject_to family, an objective or a backend
+		class family_scope
+		{
+			profiler * _profiler;
+			family_statistics * _family;
+			family_statistics * _previous;
+			scope * _previous_scope;
+			clock::time_point _start;
+			size_t _start_bytes;
+		public:
+			family_scope(const std::string& name, family_kind kind);
+			~family_scope();
+			family_scope(const family_scope&) = delete;
+			family_scope& operator=(const family_scope&) = delete;
+
+			bool active() const { return _family != nullptr; }
+			void add_rows(size_t rows, size_t nonzeros);
+		};
+
+		// Times one category of work inside the current family. Nested scopes are
+		// subtracted from their parent, so every category reports self time.
+		class scope
+		{
+			family_statistics * _family;
+			scope * _parent;
+			category _category;
+			clock::time_point _start;
+			double _child_time = 0;
+
+			void begin();
+			void end();
+		public:
+			explicit scope(category c) : _family(nullptr), _category(c) { if (profiler::current()) begin(); }
+			~scope() { if (_family) end(); }
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+		};
+	};
+}
+
+#ifdef MILPCPP_NO_PROFILING
+#define MILPCPP_PROFILE(CATEGORY)
+#else
+#define MILPCPP_PROFILE(CATEGORY) milpcpp::profiling::scope __milpcpp_profile_scope__(milpcpp::profiling::category::CATEGORY)
+#endif
+
+#endif
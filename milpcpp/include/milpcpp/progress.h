@@ -0,0 +1,113 @@
+#ifndef __MILPCPP_PROGRESS_H__
+#define __MILPCPP_PROGRESS_H__
+
+#include<atomic>
+#include<chrono>
+#include<functional>
+#include<memory>
+#include<optional>
+
+namespace milpcpp
+{
+	// Snapshot of a running solve, passed to the progress callback from the
+	// thread that runs the solve.
+	struct progress
+	{
+		size_t _iterations = 0;				// simplex iterations
+		size_t _nodes = 0;					// branch and bound nodes, MIP only
+		std::optional<double> _objective;	// current objective, the incumbent for a MIP
+		std::optional<double> _bound;		// best bound, MIP only
+		std::optional<double> _mip_gap;		// relative
+		double _elapsed = 0;				// seconds since the solve started
+	};
+
+	typedef std::function<void(const progress&)> progress_callback;
+
+	// Shared stop flag. Copies refer to the same flag, so a token handed to a
+	// backend can be cancelled from any thread; the backend polls it from its
+	// solver callbacks and stops at the next one. A linked token is also
+	// cancelled with the one it was made from.
+	class cancellation
+	{
+		typedef std::chrono::steady_clock clock;
+
+		struct state
+		{
+			std::atomic<bool> _cancelled{ false };
+			std::atomic<clock::rep> _deadline{ clock::time_point::max().time_since_epoch().count() };
+			std::shared_ptr<const state> _parent;
+
+			bool cancelled() const
+			{
+				return _cancelled || clock::now().time_since_epoch().count() >= _deadline
+					|| (_parent && _parent->cancelled());
+			}
+		};
+		std::shared_ptr<state> _state;
+	public:
+		cancellation() : _state(std::make_shared<state>()) {}
+
+		// A token of its own, cancelled by itself, its deadline or this one
+		cancellation linked() const
+		{
+			cancellation c;
+			c._state->_parent = _state;
+			return c;
+		}
+
+		void cancel() { _state->_cancelled = true; }
+
+		// Cancels once the deadline has passed
+		void set_deadline(clock::time_point deadline) { _state->_deadline = deadline.time_since_epoch().count(); }
+
+		template<typename Rep, typename Period>
+		void cancel_after(const std::chrono::duration<Rep, Period>& timeout)
+		{
+			set_deadline(clock::now() + std::chrono::duration_cast<clock::duration>(timeout));
+		}
+
+		bool cancelled() const { return _state->cancelled(); }
+	};
+
+	// What a backend needs to report progress and honour cancellation
+	struct solve_control
+	{
+		typedef std::chrono::steady_clock clock;
+
+		std::optional<cancellation> _cancellation;
+		bool _interrupt = false;			// a solver with no hook to stop it may split its work to poll _cancellation
+		progress_callback _progress;
+		double _progress_interval = 0.1;	// seconds between two polled reports
+		clock::time_point _start;
+		clock::time_point _last_report;
+
+		bool active() const { return _cancellation.has_value() || _progress; }
+		bool cancelled() const { return _cancellation.has_value() && _cancellation->cancelled(); }
+
+		void start() { _start = _last_report = clock::now(); }
+
+		double elapsed() const { return std::chrono::duration<double>(clock::now() - _start).count(); }
+
+		// Throttles the reports of callbacks the solver calls very often
+		bool report_due()
+		{
+			if (!_progress)
+				return false;
+			auto now = clock::now();
+			if (std::chrono::duration<double>(now - _last_report).count() < _progress_interval)
+				return false;
+			_last_report = now;
+			return true;
+		}
+
+		void report(progress p)
+		{
+			if (!_progress)
+				return;
+			p._elapsed = elapsed();
+			_progress(p);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef __MILPCPP_ROLLING_HORIZON_H__
+#define __MILPCPP_ROLLING_HORIZON_H__
+
+#include<array>
+#include<limits>
+#include<optional>
+#include<ostream>
+#include<type_traits>
+#include<vector>
+
+#include<milpcpp/backend.h>
+#include<milpcpp/var.h>
+
+namespace milpcpp
+{
+	struct rolling_horizon_options
+	{
+		size_t _window = 4;			// periods solved together
+		size_t _overlap = 1;		// periods of a window solved again by the next, less than _window
+		bool _warm_start = true;	// start each window from the basis the last one ended with
+		bool _monolithic = false;	// also solve the whole horizon at once, for the report
+	};
+
+	struct rolling_horizon_report
+	{
+		solve_status _status = solve_status::not_solved;	// of the last window solved
+		std::optional<double> _objective;		// of the plan, set when every window had a solution
+		std::vector<solve_result> _windows;
+		timing _total;							// load and solve of all windows
+		std::optional<solve_result> _monolithic;
+
+		void write_json(std::ostream& out) const;
+	};
+
+	// Solves a time indexed model window by window: the first _window
+	// periods, then, keeping the periods before the overlap at the values
+	// found, the next ones, until the last period. Variables of periods
+	// after a window are fixed at their bound nearest to zero and the rows
+	// using them left out, so a window sees only what it decides and what
+	// is already committed. Variables not added have no period and are
+	// solved again in every window.
+	//
+	// The model's matrix is built once, with semi-continuous variables and
+	// SOS sets linearized. A window only frees columns, so the problem is
+	// loaded once too: each window changes the bounds of the columns whose
+	// period it commits or takes in and appends the rows that no longer use
+	// a later column, and the solver goes on from its last basis. A backend
+	// that cannot change a loaded problem (lp_solve, dual_simplex) loads
+	// every window, starting from the last window's basis mapped onto it.
+	// When solve() returns, the backend holds the values of the whole plan.
+	class rolling_horizon
+	{
+		static constexpr long no_period = std::numeric_limits<long>::min();
+
+		model * _model;
+		backend * _backend;
+		rolling_horizon_options _options;
+
+		std::vector<long> _period;		// by variable
+		std::vector<double> _committed;	// by variable
+		std::vector<long> _column_period;	// by column of the full matrix
+		std::vector<char> _in_window;	// by row of the full matrix
+		std::vector<int> _kept_rows;	// of the full matrix, by row of the window
+		std::vector<basis_status> _row_basis;	// by row of the full matrix
+		std::vector<basis_status> _column_basis;
+
+		void set_bounds(const matrix& full, matrix& m, long first, long last, std::vector<int>& changed);
+		void add_rows(const matrix& full, matrix& m, long last);
+		void warm_start(const matrix& m);
+	public:
+		rolling_horizon(model * m, backend * solver, const rolling_horizon_options& o = rolling_horizon_options()) :
+			_model(m), _backend(solver), _options(o) {}
+
+		rolling_horizon(const rolling_horizon&) = delete;
+		rolling_horizon& operator=(const rolling_horizon&) = delete;
+
+		// Takes the period of each of vars from its index over S, a range or
+		// a set in time order; ranges with different lower ends, such as
+		// range<0, T> and range<1, T>, line up by value. Call after
+		// seal_data().
+		template<typename S, typename ... Ts>
+		void add(const var<Ts...>& vars)
+		{
+			static_assert((std::is_same_v<S, Ts> + ...) == 1, "The variable must be indexed by S exactly once");
+			constexpr std::array<bool, sizeof...(Ts)> match{ std::is_same_v<S, Ts>... };
+			size_t component = 0;
+			while (!match[component])
+				++component;
+			size_t stride = get_strides<Ts...>()[component];
+
+			long shift = 0;
+			if constexpr (std::is_same_v<typename S::lookup_type, long>)
+				shift = -(long)S::index_of(0);
+
+			if (_period.size() < _model->variable_count())
+				_period.resize(_model->variable_count(), no_period);
+			for (size_t i = 0; i < vars.size(); ++i)
+				_period[vars.start_index() + i] = (long)(i / stride % S::size()) + shift;
+		}
+
+		void set_options(const rolling_horizon_options& o) { _options = o; }
+		const rolling_horizon_options& get_options() const { return _options; }
+
+		// Throws std::invalid_argument for a window of no periods or an
+		// overlap as long as it, std::logic_error when no variable was added
+		rolling_horizon_report solve();
+	};
+}
+
+#endif
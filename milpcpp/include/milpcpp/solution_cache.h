@@ -0,0 +1,78 @@
+#ifndef __MILPCPP_SOLUTION_CACHE_H__
+#define __MILPCPP_SOLUTION_CACHE_H__
+
+#include<cstdint>
+#include<list>
+#include<mutex>
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+#include<milpcpp/fingerprint.h>
+#include<milpcpp/solve_result.h>
+
+namespace milpcpp
+{
+	enum class basis_status : uint8_t { basic, lower, upper, free, fixed };
+
+	struct cached_solution
+	{
+		solve_result _result;
+		std::vector<double> _values;				// by column
+		std::vector<basis_status> _row_basis;		// empty when the backend gave no basis
+		std::vector<basis_status> _column_basis;
+	};
+
+	// Solutions of models solved before, keyed by model::compute_fingerprint().
+	// Implementations must be safe to use from several solving threads.
+	class solution_cache
+	{
+	public:
+		virtual ~solution_cache() {}
+		virtual bool find(const fingerprint& key, cached_solution& solution) = 0;
+		virtual void store(const fingerprint& key, const cached_solution& solution) = 0;
+	};
+
+	// Keeps the most recently used solutions in memory. A miss is looked up
+	// in the next cache, typically a disk_cache, and stores write through.
+	class lru_cache : public solution_cache
+	{
+		typedef std::list<std::pair<fingerprint, cached_solution>> entries_t;
+
+		size_t _capacity;
+		solution_cache * _next;
+		mutable std::mutex _mutex;
+		entries_t _entries;			// most recently used first
+		std::unordered_map<fingerprint, entries_t::iterator> _index;
+
+		void insert(const fingerprint& key, const cached_solution& solution);
+	public:
+		explicit lru_cache(size_t capacity, solution_cache * next = nullptr) : _capacity(capacity), _next(next) {}
+
+		bool find(const fingerprint& key, cached_solution& solution) override;
+		void store(const fingerprint& key, const cached_solution& solution) override;
+
+		size_t size() const;
+		void clear();
+	};
+
+	// One file per solution in a directory, which may be shared between
+	// processes; files are written to a temporary name and renamed.
+	class disk_cache : public solution_cache
+	{
+		std::string _directory;
+
+		std::string path(const fingerprint& key) const;
+	public:
+		explicit disk_cache(const std::string& directory);
+
+		bool find(const fingerprint& key, cached_solution& solution) override;
+		void store(const fingerprint& key, const cached_solution& solution) override;
+	};
+
+	// Looks a solve up; on a hit, result becomes the cached one, marked as a
+	// hit and keeping the presolve and fingerprint timings of this solve.
+	bool find_solution(solution_cache& cache, const fingerprint& key, cached_solution& solution, solve_result& result);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef __MILPCPP_SOLVE_RESULT_H__
+#define __MILPCPP_SOLVE_RESULT_H__
+
+#include<chrono>
+#include<optional>
+#include<ostream>
+
+namespace milpcpp
+{
+	enum class solve_status
+	{
+		not_solved,
+		optimal,
+		feasible,					// a solution, not proven optimal
+		infeasible,
+		unbounded,
+		infeasible_or_unbounded,
+		time_limit,
+		iteration_limit,
+		cancelled,
+		failed						// numerical or other solver failure
+	};
+
+	const char * status_name(solve_status status);
+
+	// CPU seconds used by the calling thread
+	double thread_cpu_time();
+
+	struct timing
+	{
+		double _wall = 0;	// seconds
+		double _cpu = 0;	// seconds, of the thread that did the work
+	};
+
+	inline void add_timing(timing& total, const timing& t)
+	{
+		total._wall += t._wall;
+		total._cpu += t._cpu;
+	}
+
+	// Adds the wall and CPU time of its lifetime to a timing
+	class stopwatch
+	{
+		timing& _timing;
+		std::chrono::steady_clock::time_point _start;
+		double _start_cpu;
+	public:
+		explicit stopwatch(timing& t) : _timing(t), _start(std::chrono::steady_clock::now()), _start_cpu(thread_cpu_time()) {}
+		~stopwatch()
+		{
+			_timing._wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+			_timing._cpu += thread_cpu_time() - _start_cpu;
+		}
+		stopwatch(const stopwatch&) = delete;
+		stopwatch& operator=(const stopwatch&) = delete;
+	};
+
+	// What a backend's solve() returns. A time or iteration limit and a
+	// cancellation may still leave a solution, see has_solution().
+	struct solve_result
+	{
+		solve_status _status = solve_status::not_solved;
+		std::optional<double> _objective;	// set when there is a solution
+		size_t _iterations = 0;				// simplex iterations, all phases and nodes
+		size_t _nodes = 0;					// branch and bound nodes, MIP only
+		int _backend_code = 0;				// return code of the backend's solve call
+		bool _cache_hit = false;			// served by the solution cache, not solved
+		std::optional<bool> _start_accepted;	// set when a MIP was given a start
+		timing _presolve;					// model::presolve(), zero if it did not run
+		timing _fingerprint;				// model::compute_fingerprint(), for the cache
+		timing _load;
+		timing _solve;
+
+		bool has_solution() const { return _objective.has_value(); }
+		bool optimal() const { return _status == solve_status::optimal; }
+
+		void write_json(std::ostream& out) const;
+		static void write_csv_header(std::ostream& out);
+		void write_csv(std::ostream& out) const;
+	};
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __MILPCPP_SOLVER_OPTIONS_H__
+#define __MILPCPP_SOLVER_OPTIONS_H__
+
+#include<optional>
+
+namespace milpcpp
+{
+	enum class lp_algorithm { simplex, interior };
+
+	enum class simplex_method { automatic, primal, dual, dual_then_primal };
+
+	enum class pricing_rule { automatic, dantzig, devex, steepest_edge };
+
+	// Backend neutral solver settings. Unset values keep the backend's own
+	// defaults; settings a backend cannot honour are ignored by it.
+	struct solver_options
+	{
+		lp_algorithm _algorithm = lp_algorithm::simplex;
+		simplex_method _method = simplex_method::automatic;
+		pricing_rule _pricing = pricing_rule::automatic;
+		std::optional<bool> _presolve;			// the backend's presolver, not model::presolve()
+		bool _names = false;					// pass the variable names, e.g. to write the model out
+		std::optional<bool> _verbose;
+		std::optional<int> _iteration_limit;
+		std::optional<double> _time_limit;		// seconds
+		std::optional<double> _mip_gap;			// relative
+	};
+}
+
+#endif
@@ -1,13 +1,76 @@
 #ifndef __MILPCPP_TUPLES_H__
 #define __MILPCPP_TUPLES_H__
 
+#include<array>
+
+#include<milpcpp/indexing.h>
+
 namespace milpcpp
 {
+	template<size_t N>
+	inline size_t dot(const std::array<size_t, N>& indices, const std::array<size_t, N>& strides)
+	{
+		size_t result = 0;
+		for (size_t k = 0; k < N; ++k)
+			result += indices[k] * strides[k];
+		return result;
+	}
+
+	// Row major strides of an index tuple. A var computes its table when
+	// the model is sealed and a param when its values are laid out, and
+	// each keeps it, so an offset is a dot product against a member. When
+	// every component has a fixed size the strides are constants.
+	template<typename ... Ts>
+	struct stride_table
+	{
+		std::array<size_t, sizeof...(Ts)> _strides{};
+		size_t _size = 1;
+
+		static constexpr stride_table compute()
+		{
+			stride_table table;
+			std::array<size_t, sizeof...(Ts)> sizes{ Ts::size()... };
+			for (size_t k = sizeof...(Ts); k-- > 0;)
+			{
+				table._strides[k] = table._size;
+				table._size *= sizes[k];
+			}
+			return table;
+		}
+
+		void seal()
+		{
+			if constexpr (!indexing::all_fixed<Ts...>::value)
+				*this = compute();
+		}
+
+		size_t offset(const std::array<size_t, sizeof...(Ts)>& indices) const
+		{
+			if constexpr (sizeof...(Ts) == 1)
+				return indices[0];
+			else if constexpr (indexing::all_fixed<Ts...>::value)
+			{
+				constexpr stride_table table = compute();
+				return dot(indices, table._strides);
+			}
+			else
+				return dot(indices, _strides);
+		}
+
+		size_t offset(Ts...args) const { return offset(std::array<size_t, sizeof...(Ts)>{ args.raw_index()... }); }
+	};
+
+	// Computed on each call, for layouts read once
+	template<typename ... Ts>
+	inline std::array<size_t, sizeof...(Ts)> get_strides()
+	{
+		return stride_table<Ts...>::compute()._strides;
+	}
 
 	template<typename T1, typename ... Ts>
 	struct compound_index
 	{
-		static size_t size() { return T1::size()*compound_index<Ts...>::size(); }
+		static constexpr size_t size() { return stride_table<T1, Ts...>::compute()._size; }
 
 		static std::string name(size_t index) 
 		{ 
@@ -20,28 +83,16 @@ namespace milpcpp
 	template<typename T>
 	struct compound_index<T>
 	{
-		static size_t size() { return T::size(); }
+		static constexpr size_t size() { return T::size(); }
 		static std::string name(size_t index) { return T::name(index); }
 	};
 
-	template<typename T1, typename ... Ts>
-	size_t get_offset(T1 t1, Ts...args)
-	{
-		return t1.raw_index()*compound_index<Ts...>::size() + get_offset(args...);
-	}
-
 	template<typename T>
-	size_t get_offset(T t)
+	inline size_t get_offset(T t)
 	{
 		return t.raw_index();
 	}
 
-	template<typename T1, typename ... Ts>
-	size_t get_offset_by_lookup(const typename T1::lookup_type& n, const typename Ts::lookup_type&...args)
-	{
-		return T1::index_of(n)*compound_index<Ts...>::size() + get_offset_by_lookup<Ts...>(args...);
-	}
-
 	template<typename T>
 	size_t get_offset_by_lookup(const typename T::lookup_type&n)
 	{
@@ -1,6 +1,7 @@
 #ifndef __MILPCPP_UTILS_H__
 #define __MILPCPP_UTILS_H__
 
+#include<tuple>
 #include<type_traits>
 
 namespace milpcpp
@@ -19,8 +20,10 @@ namespace milpcpp
 			enum { arity = sizeof...(Args) };
 
 			typedef ReturnType result_type;
+			typedef std::tuple<Args...> arguments;
 
 			typedef std::function<ReturnType(Args...)> function_type;
+			typedef std::function<bool(Args...)> predicate_type;
 
 			template <size_t i>
 			struct arg
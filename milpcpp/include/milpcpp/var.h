@@ -1,6 +1,10 @@
 #ifndef __MILPCPP_VAR_H__
 #define __MILPCPP_VAR_H__
 
+#include<algorithm>
+#include<array>
+#include<typeindex>
+
 #include<milpcpp/tuples.h>
 
 namespace milpcpp
@@ -14,24 +18,70 @@ namespace milpcpp
 			return compound_index<Ts...>::name(absolute_index - _start_index);
 		}
 
-		bool has_lower_bound() const override { return (bool)_lower_bound; }
-		bool has_upper_bound() const override { return (bool)_upper_bound; }
+		bool has_lower_bound() const override { return _lower_bound.defined(); }
+		bool has_upper_bound() const override { return _upper_bound.defined(); }
+
+		double get_lower_bound(size_t absolute_index) const override { return _lower_bound.get(absolute_index - _start_index); }
+		double get_upper_bound(size_t absolute_index) const override { return _upper_bound.get(absolute_index - _start_index); }
+
+		void seal() override
+		{
+			_strides.seal();
+			_lower_bound.seal();
+			_upper_bound.seal();
+		}
+
+		void get_sos_layout(size_t& stride, size_t& length) const override
+		{
+			std::array<size_t, sizeof...(Ts)> sizes{ Ts::size()... };
+			stride = get_strides<Ts...>()[_sos_component];
+			length = sizes[_sos_component];
+		}
+
+		bool get_index_layout(std::type_index set, size_t& stride, size_t& size) const override
+		{
+			std::array<std::type_index, sizeof...(Ts)> sets{ std::type_index(typeid(Ts))... };
+			if (std::count(sets.begin(), sets.end(), set) != 1)
+				return false;
+			size_t component = std::find(sets.begin(), sets.end(), set) - sets.begin();
+			std::array<size_t, sizeof...(Ts)> sizes{ Ts::size()... };
+			stride = get_strides<Ts...>()[component];
+			size = sizes[component];
+			return true;
+		}
 
-		double get_lower_bound(size_t absolute_index) const override { return invoke(absolute_index - _start_index, _lower_bound); }
-		double get_upper_bound(size_t absolute_index) const override { return invoke(absolute_index - _start_index, _upper_bound); }
+		void get_index_sets(std::vector<std::type_index>& sets) const override
+		{
+			(sets.push_back(typeid(Ts)), ...);
+		}
 
 		lower_bound<false, Ts...> _lower_bound;
 		upper_bound<false, Ts...> _upper_bound;
+		stride_table<Ts...> _strides;			// set at seal
 	public :
 		var() { init();  }
 
 		size_t size() const override { return compound_index<Ts...>::size(); }
 
 		typedef std::function<void(double, Ts...)> value_iterator_t;
+		typedef std::function<double(Ts...)> value_function_t;
+
+		// Every combination of the other indices makes one set of the
+		// variables over S, weighted by their position in S
+		template<typename S>
+		void set_sos(sos_type type)
+		{
+			static_assert((std::is_same_v<S, Ts> + ...) == 1, "The variable must be indexed by S exactly once");
+			constexpr std::array<bool, sizeof...(Ts)> match{ std::is_same_v<S, Ts>... };
+			_sos_component = 0;
+			while (!match[_sos_component])
+				++_sos_component;
+			_sos = type;
+		}
 
 		expression operator()(Ts...args)
 		{
-			return expressions::variable{ _start_index, get_offset(args...) };
+			return expressions::variable{ (uint32_t)(_start_index + _strides.offset(args...)) };
 
 		}
 
@@ -0,0 +1,94 @@
+#ifndef __MILPCPP_WORKER_H__
+#define __MILPCPP_WORKER_H__
+
+#include<chrono>
+#include<condition_variable>
+#include<deque>
+#include<functional>
+#include<future>
+#include<memory>
+#include<mutex>
+#include<thread>
+
+namespace milpcpp
+{
+	// A thread that runs the tasks posted to it in order, until it is
+	// destroyed after the last one. With a capacity, post() blocks while
+	// that many tasks wait, which caps the work in flight.
+	class worker
+	{
+	public:
+		typedef std::function<void()> task;
+	private:
+		size_t _capacity;					// 0 for no limit
+		std::mutex _mutex;
+		std::condition_variable _not_empty;
+		std::condition_variable _not_full;
+		std::deque<task> _tasks;
+		bool _stopping = false;
+		double _blocked_time = 0;			// seconds post() waited for a free slot
+		std::thread _thread;
+
+		void work()
+		{
+			for (;;)
+			{
+				task t;
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					_not_empty.wait(lock, [&]() { return _stopping || !_tasks.empty(); });
+					if (_tasks.empty())
+						return;
+					t = std::move(_tasks.front());
+					_tasks.pop_front();
+				}
+				_not_full.notify_one();
+				t();
+			}
+		}
+	public:
+		explicit worker(size_t capacity = 0) : _capacity(capacity), _thread([this]() { work(); }) {}
+
+		~worker()
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stopping = true;
+			}
+			_not_empty.notify_one();
+			_thread.join();
+		}
+
+		worker(const worker&) = delete;
+		worker& operator=(const worker&) = delete;
+
+		void post(task t)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			if (_capacity != 0 && _tasks.size() >= _capacity)
+			{
+				auto start = std::chrono::steady_clock::now();
+				_not_full.wait(lock, [&]() { return _tasks.size() < _capacity; });
+				_blocked_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+			_tasks.push_back(std::move(t));
+			lock.unlock();
+			_not_empty.notify_one();
+		}
+
+		// Posts f and returns the future of its result or exception
+		template<typename F>
+		auto submit(F f) -> std::future<decltype(f())>
+		{
+			auto t = std::make_shared<std::packaged_task<decltype(f())()>>(std::move(f));
+			auto future = t->get_future();
+			post([t]() { (*t)(); });
+			return future;
+		}
+
+		// Read on the posting thread
+		double blocked_time() const { return _blocked_time; }
+	};
+}
+
+#endif
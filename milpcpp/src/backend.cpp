@@ -0,0 +1,380 @@
+#include<milpcpp/backend.h>
+#include<milpcpp/dual_simplex.h>
+#include<milpcpp/glpk.h>
+#include<milpcpp/lp_solve.h>
+#include<milpcpp/milpcpp.h>
+
+#ifdef MILPCPP_WITH_HIGHS
+#include<milpcpp/highs.h>
+#endif
+#ifdef MILPCPP_WITH_CBC
+#include<milpcpp/cbc.h>
+#endif
+
+#include<algorithm>
+#include<cmath>
+#include<limits>
+#include<map>
+#include<mutex>
+#include<stdexcept>
+
+using namespace milpcpp;
+
+namespace
+{
+	template<typename Backend>
+	std::unique_ptr<backend> make(model * m, const solver_options& o)
+	{
+		typename Backend::options options;
+		static_cast<solver_options&>(options) = o;
+		return std::make_unique<Backend>(m, options);
+	}
+
+	// The built in backends are listed here rather than registered from
+	// their own files, which a static library would leave out of programs
+	// that never name them
+	struct registry
+	{
+		std::mutex _mutex;
+		std::map<std::string, backend_factory> _factories;
+
+		registry()
+		{
+			_factories["dual_simplex"] = make<dual_simplex>;
+			_factories["glpk"] = make<glpk>;
+			_factories["lp_solve"] = make<lp_solve>;
+#ifdef MILPCPP_WITH_HIGHS
+			_factories["highs"] = make<highs>;
+#endif
+#ifdef MILPCPP_WITH_CBC
+			_factories["cbc"] = make<cbc>;
+#endif
+		}
+	};
+
+	registry& factories()
+	{
+		static registry r;
+		return r;
+	}
+}
+
+namespace milpcpp
+{
+	backend::~backend()
+	{
+		if (_attached)
+			_model->detach();
+	}
+
+	void backend::attach()
+	{
+		_matrix = matrix();
+		_loaded_rows = 0;
+		_streaming = loads_incrementally() && !_transform;
+		if (_streaming)
+		{
+			// Rows stored before attaching follow the streamed ones, solve()
+			// loads them with the objective
+			_model->load_matrix(_matrix, common_options()._names);
+			_matrix.clear_rows();
+			_streaming = !(_matrix.has_semicontinuous() && !native_semicontinuous()) && !(_matrix.sos_count() != 0 && !native_sos());
+			if (_streaming)
+				load(_matrix);
+		}
+		_model->attach(this);
+		_attached = true;
+	}
+
+	void backend::add_row(const constraint& c)
+	{
+		_matrix.add_row(c);
+		if (_streaming && _matrix.row_count() >= stream_batch)
+			load_streamed_rows();
+	}
+
+	// The solver keeps the rows it took, so the matrix drops them. A backend
+	// that turns the first batch down gets the whole matrix at solve().
+	void backend::load_streamed_rows()
+	{
+		_streaming = append_rows(_matrix, 0, _loaded_rows);
+		if (!_streaming && _loaded_rows != 0)
+			throw std::runtime_error(std::string(name()) + " turned down streamed rows after taking others");
+		if (_streaming)
+		{
+			_loaded_rows += _matrix.row_count();
+			_matrix.clear_rows();
+		}
+	}
+
+	// Passes on the bounds and integrality changed since attach() loaded the
+	// columns; false for changes the hooks cannot make
+	bool backend::update_columns(const matrix& attached)
+	{
+		const matrix& m = _matrix;
+		if (m._columns != attached._columns || m._semicontinuous != attached._semicontinuous ||
+			m._sos_types != attached._sos_types || m._sos_starts != attached._sos_starts ||
+			m._sos_columns != attached._sos_columns || m._sos_weights != attached._sos_weights)
+			return false;
+		std::vector<int> bounds, types;
+		for (size_t j = 0; j < m._columns; ++j)
+		{
+			if (m._column_lower[j] != attached._column_lower[j] || m._column_upper[j] != attached._column_upper[j])
+				bounds.push_back((int)j);
+			bool integer = m.has_integers() && m._integer[j];
+			if (integer != (attached.has_integers() && attached._integer[j]))
+				types.push_back((int)j);
+		}
+		return (bounds.empty() || change_column_bounds(m, bounds)) && (types.empty() || change_column_types(m, types));
+	}
+
+	solve_result backend::solve()
+	{
+		profiling::family_scope family(name(), profiling::family_kind::backend);
+		_result = solve_result();
+		_result._presolve = _model->presolve_timing();
+		_solution = cached_solution();
+		_start_columns.clear();
+
+		fingerprint key;
+		bool cache = _cache && !_attached && !_model->has_streamed_rows() && !_transform;
+		if (cache)
+		{
+			{
+				stopwatch watch(_result._fingerprint);
+				key = _model->compute_fingerprint();
+			}
+			if (find_solution(*_cache, key, _solution, _result))
+				return _result;
+		}
+
+		{
+			MILPCPP_PROFILE(load);
+			stopwatch watch(_result._load);
+			matrix attached;
+			if (_attached)
+			{
+				_model->detach();
+				_attached = false;
+				if (_streaming)
+				{
+					attached = _matrix;
+					attached.clear_rows();
+				}
+			}
+			else
+			{
+				_matrix = matrix();
+				_streaming = false;
+				_loaded_rows = 0;
+			}
+			_model->load_matrix(_matrix, common_options()._names);
+			if (_transform)
+				_transform(_matrix);
+			if (!_start.empty() && _matrix.is_mip())
+				check_start(_matrix);
+			size_t columns = _matrix._columns;
+			_matrix.linearize(!native_semicontinuous(), !native_sos(), _start_columns);
+
+			// The solver has the columns as attached and the rows streamed so
+			// far, which _matrix no longer holds
+			bool streamed = _streaming && !_transform && _matrix._columns == columns &&
+				set_objective(_matrix) && update_columns(attached) && append_rows(_matrix, 0, _loaded_rows);
+			bool incomplete = !streamed && _loaded_rows != 0;
+			_streaming = false;
+			_loaded_rows = 0;
+			if (incomplete)
+				throw std::logic_error(std::string(name()) + " cannot follow the changes to the model since attach()");
+			if (!streamed)
+				load(_matrix);
+			if (!_warm_columns.empty() && _warm_rows.size() == _matrix.row_count() && _warm_columns.size() == _matrix._columns)
+				set_basis(_warm_rows, _warm_columns);
+			_warm_rows.clear();
+			_warm_columns.clear();
+			// A gap-limited MIP optimum is not the model's, so is not cached
+			if (_matrix.is_mip() && common_options()._mip_gap)
+				cache = false;
+			_matrix = matrix();
+		}
+
+		{
+			MILPCPP_PROFILE(solve);
+			stopwatch watch(_result._solve);
+			run();
+		}
+		// Limited or cancelled incumbents depend on the options, not just the model
+		if (cache && _result.optimal())
+		{
+			get_basis(_solution._row_basis, _solution._column_basis);
+			_solution._result = _result;
+			_cache->store(key, _solution);
+		}
+		return _result;
+	}
+
+	solve_result backend::solve(const matrix& m, size_t loaded_rows)
+	{
+		profiling::family_scope family(name(), profiling::family_kind::backend);
+		_result = solve_result();
+		_solution = cached_solution();
+		_start_columns.clear();
+		{
+			MILPCPP_PROFILE(load);
+			stopwatch watch(_result._load);
+			if (loaded_rows == 0 || !append_rows(m, loaded_rows, loaded_rows))
+			{
+				load(m);
+				if (!_warm_columns.empty() && _warm_rows.size() == m.row_count() && _warm_columns.size() == m._columns)
+					set_basis(_warm_rows, _warm_columns);
+			}
+			_warm_rows.clear();
+			_warm_columns.clear();
+		}
+		{
+			MILPCPP_PROFILE(solve);
+			stopwatch watch(_result._solve);
+			run();
+		}
+		return _result;
+	}
+
+	void backend::set_start_value(size_t absolute_index, double value)
+	{
+		if (_start.empty())
+			_start.assign(_model->variable_count(), std::numeric_limits<double>::quiet_NaN());
+		_start.at(absolute_index) = value;
+	}
+
+	// A solver may trust a start, glpk does not check the rows of one
+	void backend::check_start(const matrix& m)
+	{
+		const double tolerance = 1e-6;
+		_result._start_accepted = false;
+
+		auto semicontinuous = [&](size_t j) { return m.has_semicontinuous() && m._semicontinuous[j]; };
+		_start_columns.resize(m._columns);
+		for (size_t j = 0; j < m._columns; ++j)
+			_start_columns[j] = semicontinuous(j) ? 0 : std::min(std::max(0.0, m._column_lower[j]), m._column_upper[j]);
+		for (size_t i = 0; i < _start.size(); ++i)
+		{
+			size_t column = _model->column_index(i);
+			if (!std::isnan(_start[i]) && column != presolve::postsolve_map::removed)
+				_start_columns[column] = _start[i];
+		}
+
+		bool feasible = true;
+		double objective = m._offset;
+		for (size_t j = 0; j < m._columns && feasible; ++j)
+		{
+			double& x = _start_columns[j];
+			if (m.has_integers() && m._integer[j])
+			{
+				feasible = std::abs(x - std::round(x)) <= tolerance;
+				x = std::round(x);
+			}
+			if (semicontinuous(j) && std::abs(x) <= tolerance)
+				x = 0;
+			else
+				feasible = feasible && x >= m._column_lower[j] - tolerance && x <= m._column_upper[j] + tolerance;
+			objective += m._cost[j] * x;
+		}
+
+		// Members other than the one, or two adjacent, nonzero ones go to 0
+		for (size_t k = 0; k < m.sos_count() && feasible; ++k)
+		{
+			int first = -1, last = -1;
+			for (int t = m._sos_starts[k]; t < m._sos_starts[k + 1]; ++t)
+			{
+				double& x = _start_columns[m._sos_columns[t]];
+				if (std::abs(x) <= tolerance)
+				{
+					x = 0;
+					continue;
+				}
+				if (first < 0)
+					first = t;
+				last = t;
+			}
+			feasible = first < 0 || last - first < (int)m._sos_types[k];
+		}
+		for (size_t i = 0; i < m.row_count() && feasible; ++i)
+		{
+			double activity = 0;
+			for (int k = m._row_starts[i]; k < m._row_starts[i + 1]; ++k)
+				activity += m._row_values[k] * _start_columns[m._row_indices[k]];
+			double slack = tolerance * std::max(1.0, std::abs(activity));
+			feasible = activity >= m._row_lower[i] - slack && activity <= m._row_upper[i] + slack;
+		}
+		if (!feasible)
+		{
+			_start_columns.clear();
+			return;
+		}
+		_start_objective = objective;
+		_start_minimize = m._minimize;
+	}
+
+	bool backend::kept_start() const
+	{
+		if (_start_columns.empty() || !_result._objective.has_value())
+			return false;
+		double tolerance = 1e-6 * std::max(1.0, std::abs(_start_objective));
+		double sense = _start_minimize ? 1 : -1;
+		return sense * (_result._objective.value() - _start_objective) <= tolerance;
+	}
+
+	double backend::get_variable_value(size_t absolute_index) const
+	{
+		size_t column = _model->column_index(absolute_index);
+		if (column == presolve::postsolve_map::removed)
+			return _model->removed_value(absolute_index);
+		if (column >= _solution._values.size())
+			throw std::logic_error(std::string("No ") + name() + " solution");
+		return _solution._values[column];
+	}
+
+	double backend::get_objective_value() const
+	{
+		return _result._objective.value_or(std::numeric_limits<double>::quiet_NaN());
+	}
+
+	void register_backend(const std::string& name, backend_factory factory)
+	{
+		auto& r = factories();
+		std::lock_guard<std::mutex> lock(r._mutex);
+		r._factories[name] = factory;
+	}
+
+	const char * automatic_backend(const model& m)
+	{
+		size_t rows = m.constraint_count();
+		bool mip = m.has_integers() || m.has_semicontinuous() || m.has_sos();
+		if (!mip && rows * (rows + m.column_count()) <= dual_simplex::tableau_limit)
+			return "dual_simplex";
+		return "glpk";
+	}
+
+	std::unique_ptr<backend> create_backend(const std::string& name, model * m, const solver_options& o)
+	{
+		backend_factory factory;
+		{
+			auto& r = factories();
+			std::lock_guard<std::mutex> lock(r._mutex);
+			auto found = r._factories.find(name == "auto" ? automatic_backend(*m) : name);
+			if (found == r._factories.end())
+				throw std::invalid_argument("Unknown backend " + name);
+			factory = found->second;
+		}
+		return factory(m, o);
+	}
+
+	std::vector<std::string> backend_names()
+	{
+		auto& r = factories();
+		std::lock_guard<std::mutex> lock(r._mutex);
+		std::vector<std::string> names;
+		for (const auto& f : r._factories)
+			names.push_back(f.first);
+		return names;
+	}
+}
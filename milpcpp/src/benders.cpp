@@ -0,0 +1,472 @@
+#include<milpcpp/benders.h>
+#include<milpcpp/worker.h>
+
+#include<algorithm>
+#include<cmath>
+#include<exception>
+#include<functional>
+#include<future>
+#include<limits>
+#include<stdexcept>
+#include<thread>
+
+using namespace milpcpp;
+
+namespace
+{
+	void add_row(matrix& m, const std::vector<int>& indices, const std::vector<double>& values, double lower, double upper)
+	{
+		m._row_indices.insert(m._row_indices.end(), indices.begin(), indices.end());
+		m._row_values.insert(m._row_values.end(), values.begin(), values.end());
+		m._row_starts.push_back((int)m._row_indices.size());
+		m._row_lower.push_back(lower);
+		m._row_upper.push_back(upper);
+	}
+
+	// m with a column of cost 1 on each side of every row, and no other
+	// cost: its optimum is 0 exactly when m is feasible
+	matrix elastic(const matrix& m)
+	{
+		matrix e;
+		size_t rows = m.row_count();
+		e._columns = m._columns + 2 * rows;
+		e._column_lower = m._column_lower;
+		e._column_upper = m._column_upper;
+		e._column_lower.resize(e._columns, 0);
+		e._column_upper.resize(e._columns, matrix::infinity);
+		e._cost.assign(m._columns, 0);
+		e._cost.resize(e._columns, 1);
+		e._row_lower = m._row_lower;
+		e._row_upper = m._row_upper;
+		for (size_t i = 0; i < rows; ++i)
+		{
+			e._row_indices.insert(e._row_indices.end(), m._row_indices.begin() + m._row_starts[i], m._row_indices.begin() + m._row_starts[i + 1]);
+			e._row_values.insert(e._row_values.end(), m._row_values.begin() + m._row_starts[i], m._row_values.begin() + m._row_starts[i + 1]);
+			e._row_indices.push_back((int)(m._columns + 2 * i));
+			e._row_values.push_back(1);
+			e._row_indices.push_back((int)(m._columns + 2 * i + 1));
+			e._row_values.push_back(-1);
+			e._row_starts.push_back((int)e._row_indices.size());
+		}
+		return e;
+	}
+}
+
+namespace milpcpp
+{
+	struct benders::scenario
+	{
+		matrix _matrix;						// the scenario's columns and rows, without the first stage
+		std::vector<int> _columns;			// of the model's matrix, by column of _matrix
+		std::vector<double> _lower;			// row bounds with the first stage at zero
+		std::vector<double> _upper;
+
+		// The first stage terms of the rows in the same compressed form, by
+		// first stage column of the master
+		std::vector<int> _link_starts{ 0 };
+		std::vector<int> _link_columns;
+		std::vector<double> _link_values;
+
+		std::unique_ptr<backend> _backend;
+		std::vector<basis_status> _row_basis;	// empty until a solve ends optimal
+		std::vector<basis_status> _column_basis;
+		timing _timing;
+
+		// Of the last solve: the cost, or the infeasibility when not
+		// _feasible, and its subgradient by first stage column of the master
+		solve_status _status = solve_status::not_solved;
+		bool _feasible = false;
+		double _cost = 0;
+		std::vector<double> _gradient;
+		std::vector<double> _values;
+		bool _has_cut = false;				// the scenario's cost column is free in the master
+	};
+
+	benders::benders(model * m, const benders_options& o) : _model(m), _options(o) {}
+
+	benders::~benders()
+	{
+		release();
+	}
+
+	// Runs job(b) for every scenario b on its worker and waits for all of
+	// them; the first exception is rethrown
+	void benders::for_each_scenario(const std::function<void(size_t)>& job)
+	{
+		std::vector<std::future<void>> done;
+		for (size_t b = 0; b < _scenarios.size(); ++b)
+			done.push_back(_workers[b % _workers.size()]->submit([&job, b]() { job(b); }));
+		std::exception_ptr error;
+		for (auto& f : done)
+		{
+			try
+			{
+				f.get();
+			}
+			catch (...)
+			{
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	// Destroys the subproblem backends on the threads that created them,
+	// then the workers
+	void benders::release()
+	{
+		for (size_t b = 0; b < _scenarios.size() && !_workers.empty(); ++b)
+		{
+			scenario * s = _scenarios[b].get();
+			_workers[b % _workers.size()]->post([s]() { s->_backend.reset(); });
+		}
+		_workers.clear();
+	}
+
+	void benders::build()
+	{
+		release();
+		block_structure blocks = _scenario_set ? _model->detect_blocks(*_scenario_set) : _model->detect_blocks();
+		if (!blocks.decomposable())
+			throw std::logic_error("Benders decomposition needs variables over two or more scenarios");
+
+		matrix full;
+		_model->load_matrix(full, false);
+		if (full.has_semicontinuous() || full.sos_count() != 0)
+			throw std::logic_error("Benders decomposition takes neither semi-continuous variables nor SOS sets");
+		_sign = full._minimize ? 1 : -1;
+
+		auto first_stage = [&](size_t column) {
+			size_t absolute_index = _model->original_index(column);
+			return absolute_index < _first_stage.size() && _first_stage[absolute_index];
+		};
+		_master_columns.clear();
+		_scenarios.clear();
+		for (size_t s = 0; s < blocks._blocks; ++s)
+			_scenarios.push_back(std::make_unique<scenario>());
+
+		// Column j goes to the master or to its scenario, at local[j]
+		std::vector<int> local(full._columns);
+		for (size_t j = 0; j < full._columns; ++j)
+		{
+			int b = blocks._column_block[j];
+			if (b == block_structure::linking)
+			{
+				if (!first_stage(j))
+					throw std::logic_error("Variable " + _model->variable_name(j) + " is neither first stage nor indexed over the scenarios");
+				local[j] = (int)_master_columns.size();
+				_master_columns.push_back((int)j);
+				continue;
+			}
+			if (first_stage(j))
+				throw std::logic_error("First stage variable " + _model->variable_name(j) + " is indexed over the scenarios");
+			if (full.has_integers() && full._integer[j])
+				throw std::invalid_argument("Benders subproblems must be LPs, " + _model->variable_name(j) + " is integer");
+			scenario& s = *_scenarios[b];
+			local[j] = (int)s._columns.size();
+			s._columns.push_back((int)j);
+			s._matrix._column_lower.push_back(full._column_lower[j]);
+			s._matrix._column_upper.push_back(full._column_upper[j]);
+			s._matrix._cost.push_back(_sign * full._cost[j]);
+		}
+
+		// One cost column per scenario after the first stage, fixed at zero
+		// while the scenario has no cut unless its cost is bounded
+		size_t first_count = _master_columns.size();
+		_master = matrix();
+		_master._columns = first_count + _scenarios.size();
+		_master._offset = _sign * full._offset;
+		for (int j : _master_columns)
+		{
+			_master._column_lower.push_back(full._column_lower[j]);
+			_master._column_upper.push_back(full._column_upper[j]);
+			_master._cost.push_back(_sign * full._cost[j]);
+		}
+		bool bounded = std::isfinite(_options._recourse_bound);
+		_master._column_lower.resize(_master._columns, bounded ? _options._recourse_bound : 0);
+		_master._column_upper.resize(_master._columns, bounded ? matrix::infinity : 0);
+		_master._cost.resize(_master._columns, 1);
+		if (full.has_integers())
+		{
+			_master._integer.assign(_master._columns, 0);
+			for (size_t c = 0; c < first_count; ++c)
+				_master._integer[c] = full._integer[_master_columns[c]];
+			if (std::find(_master._integer.begin(), _master._integer.end(), 1) == _master._integer.end())
+				_master._integer.clear();
+		}
+
+		std::vector<int> indices;
+		std::vector<double> values;
+		for (size_t i = 0; i < full.row_count(); ++i)
+		{
+			int b = blocks._row_block[i];
+			scenario * s = b == block_structure::linking ? nullptr : _scenarios[b].get();
+			indices.clear();
+			values.clear();
+			for (int k = full._row_starts[i]; k < full._row_starts[i + 1]; ++k)
+			{
+				int j = full._row_indices[k];
+				if (blocks._column_block[j] == block_structure::linking && s != nullptr)
+				{
+					s->_link_columns.push_back(local[j]);
+					s->_link_values.push_back(full._row_values[k]);
+				}
+				else if (blocks._column_block[j] == block_structure::linking || blocks._column_block[j] == b)
+				{
+					indices.push_back(local[j]);
+					values.push_back(full._row_values[k]);
+				}
+				else
+					throw std::logic_error("Row " + std::to_string(i) + " links scenarios, Benders decomposition needs rows of one scenario");
+			}
+			if (s == nullptr)
+				add_row(_master, indices, values, full._row_lower[i], full._row_upper[i]);
+			else
+			{
+				add_row(s->_matrix, indices, values, full._row_lower[i], full._row_upper[i]);
+				s->_link_starts.push_back((int)s->_link_columns.size());
+			}
+		}
+
+		_master_backend = create_backend(_options._master_backend, _model, _options._solver_options);
+		for (auto& s : _scenarios)
+		{
+			s->_matrix._columns = s->_columns.size();
+			s->_lower = s->_matrix._row_lower;
+			s->_upper = s->_matrix._row_upper;
+		}
+
+		// Scenario b stays on worker b % threads, which creates, solves and
+		// destroys its backend
+		size_t threads = _options._threads != 0 ? _options._threads : std::max(1u, std::thread::hardware_concurrency());
+		threads = std::min(threads, _scenarios.size());
+		for (size_t t = 0; t < threads; ++t)
+			_workers.push_back(std::make_unique<worker>());
+		for_each_scenario([this](size_t b) {
+			_scenarios[b]->_backend = create_backend(_options._subproblem_backend, _model, _options._solver_options);
+		});
+	}
+
+	// Solves the scenario with the first stage at plan, and its elastic
+	// version when that is infeasible; the subgradient of the cost, or the
+	// infeasibility, comes from the row duals
+	void benders::solve_scenario(scenario& s, const std::vector<double>& plan)
+	{
+		matrix& m = s._matrix;
+		for (size_t i = 0; i < m.row_count(); ++i)
+		{
+			double shift = 0;
+			for (int k = s._link_starts[i]; k < s._link_starts[i + 1]; ++k)
+				shift += s._link_values[k] * plan[s._link_columns[k]];
+			m._row_lower[i] = s._lower[i] - shift;
+			m._row_upper[i] = s._upper[i] - shift;
+		}
+
+		if (!s._row_basis.empty())
+			s._backend->set_warm_start(s._row_basis, s._column_basis);
+		solve_result result = s._backend->solve(m);
+		add_timing(s._timing, result._load);
+		add_timing(s._timing, result._solve);
+		s._status = result._status;
+		s._feasible = result.optimal();
+		if (result.optimal())
+			s._backend->get_final_basis(s._row_basis, s._column_basis);
+		else if (result._status == solve_status::infeasible || result._status == solve_status::infeasible_or_unbounded)
+		{
+			s._row_basis.clear();
+			s._column_basis.clear();
+			result = s._backend->solve(elastic(m));
+			add_timing(s._timing, result._load);
+			add_timing(s._timing, result._solve);
+			s._status = result.optimal() ? solve_status::infeasible : result._status;
+		}
+		if (!result.optimal())
+			return;
+
+		s._cost = result._objective.value();
+		s._values = s._backend->cache_entry()._values;
+		std::vector<double> duals;
+		s._backend->get_row_duals(duals);
+		if (duals.size() != m.row_count())
+			throw std::logic_error(std::string("Benders decomposition needs row duals, ") + s._backend->name() + " has none");
+		s._gradient.assign(_master_columns.size(), 0);
+		for (size_t i = 0; i < m.row_count(); ++i)
+		{
+			for (int k = s._link_starts[i]; k < s._link_starts[i + 1]; ++k)
+				s._gradient[s._link_columns[k]] -= duals[i] * s._link_values[k];
+		}
+	}
+
+	benders_report benders::solve()
+	{
+		build();
+		benders_report report;
+		_values.clear();
+		_objective.reset();
+
+		size_t first_count = _master_columns.size();
+		size_t loaded_rows = 0;
+		double best = std::numeric_limits<double>::infinity();
+		std::vector<double> plan(first_count);
+		std::vector<int> indices;
+		std::vector<double> values;
+		while (true)
+		{
+			solve_result master = _master_backend->solve(_master, loaded_rows);
+			loaded_rows = _master.row_count();
+			add_timing(report._master, master._load);
+			add_timing(report._master, master._solve);
+			if (!master.has_solution())
+			{
+				report._status = master._status;
+				break;
+			}
+			const std::vector<double>& x = _master_backend->cache_entry()._values;
+			std::copy(x.begin(), x.begin() + first_count, plan.begin());
+
+			bool bounded = std::isfinite(_options._recourse_bound) ||
+				std::all_of(_scenarios.begin(), _scenarios.end(), [](const auto& s) { return s->_has_cut; });
+			if (bounded && master.optimal())
+				report._bound = master._objective;
+
+			timing round;
+			{
+				stopwatch watch(round);
+				for_each_scenario([&](size_t b) { solve_scenario(*_scenarios[b], plan); });
+			}
+			report._subproblem_wall += round._wall;
+			++report._iterations;
+
+			auto failed = std::find_if(_scenarios.begin(), _scenarios.end(), [](const auto& s) {
+				return s->_status != solve_status::optimal && s->_status != solve_status::infeasible;
+			});
+			if (failed != _scenarios.end())
+			{
+				report._status = (*failed)->_status;
+				break;
+			}
+
+			if (std::all_of(_scenarios.begin(), _scenarios.end(), [](const auto& s) { return s->_feasible; }))
+			{
+				double total = _master._offset;
+				for (size_t c = 0; c < first_count; ++c)
+					total += _master._cost[c] * plan[c];
+				for (const auto& s : _scenarios)
+					total += s->_cost;
+				if (total < best)
+				{
+					best = total;
+					_values.assign(_model->column_count(), 0);
+					for (size_t c = 0; c < first_count; ++c)
+						_values[_master_columns[c]] = plan[c];
+					for (const auto& s : _scenarios)
+					{
+						for (size_t k = 0; k < s->_columns.size(); ++k)
+							_values[s->_columns[k]] = s->_values[k];
+					}
+				}
+			}
+
+			// Both cuts read cost column - g x >= Q - g plan, an infeasible
+			// scenario's without the cost column
+			size_t cuts = 0;
+			for (size_t b = 0; b < _scenarios.size(); ++b)
+			{
+				scenario& s = *_scenarios[b];
+				size_t column = first_count + b;
+				if (s._feasible && s._has_cut && x[column] >= s._cost - 1e-7 * std::max(1.0, std::abs(s._cost)))
+					continue;
+
+				indices.clear();
+				values.clear();
+				double lower = s._cost;
+				for (size_t c = 0; c < first_count; ++c)
+				{
+					if (s._gradient[c] == 0)
+						continue;
+					indices.push_back((int)c);
+					values.push_back(-s._gradient[c]);
+					lower -= s._gradient[c] * plan[c];
+				}
+				if (s._feasible)
+				{
+					if (!s._has_cut && !std::isfinite(_options._recourse_bound))
+					{
+						// Freeing the column changes the loaded master
+						_master._column_lower[column] = -matrix::infinity;
+						_master._column_upper[column] = matrix::infinity;
+						loaded_rows = 0;
+					}
+					s._has_cut = true;
+					indices.push_back((int)column);
+					values.push_back(1);
+					++report._optimality_cuts;
+				}
+				else
+					++report._feasibility_cuts;
+				add_row(_master, indices, values, lower, matrix::infinity);
+				++cuts;
+			}
+
+			if (cuts == 0)
+			{
+				// The master's estimate is the plan's cost
+				report._status = master.optimal() ? solve_status::optimal : solve_status::feasible;
+				break;
+			}
+			if (report._bound.has_value() && std::isfinite(best) && best - report._bound.value() <= _options._gap * std::max(1.0, std::abs(best)))
+			{
+				report._status = solve_status::optimal;
+				break;
+			}
+			if (report._iterations >= _options._iteration_limit)
+			{
+				report._status = solve_status::iteration_limit;
+				break;
+			}
+		}
+
+		for (const auto& s : _scenarios)
+			add_timing(report._subproblems, s->_timing);
+		if (std::isfinite(best))
+		{
+			_objective = _sign * best;
+			report._objective = _objective;
+		}
+		if (report._bound.has_value())
+			report._bound = _sign * report._bound.value();
+		return report;
+	}
+
+	double benders::get_variable_value(size_t absolute_index) const
+	{
+		size_t column = _model->column_index(absolute_index);
+		if (column == presolve::postsolve_map::removed)
+			return _model->removed_value(absolute_index);
+		if (column >= _values.size())
+			throw std::logic_error("No Benders solution");
+		return _values[column];
+	}
+
+	double benders::get_objective_value() const
+	{
+		return _objective.value_or(std::numeric_limits<double>::quiet_NaN());
+	}
+
+	void benders_report::write_json(std::ostream& out) const
+	{
+		out << "{\"status\": \"" << status_name(_status) << "\"";
+		if (_objective.has_value())
+			out << ", \"objective\": " << _objective.value();
+		if (_bound.has_value())
+			out << ", \"bound\": " << _bound.value();
+		out << ", \"iterations\": " << _iterations
+			<< ", \"optimality_cuts\": " << _optimality_cuts
+			<< ", \"feasibility_cuts\": " << _feasibility_cuts
+			<< ", \"master_wall_time\": " << _master._wall << ", \"master_cpu_time\": " << _master._cpu
+			<< ", \"subproblem_wall_time\": " << _subproblem_wall << ", \"subproblem_cpu_time\": " << _subproblems._cpu
+			<< "}";
+	}
+}
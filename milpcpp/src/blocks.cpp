@@ -0,0 +1,147 @@
+#include<milpcpp/model.h>
+
+#include<algorithm>
+#include<limits>
+#include<stdexcept>
+#include<variant>
+
+using namespace milpcpp;
+
+namespace
+{
+	template<typename F>
+	void for_each_column(const expression& e, F f)
+	{
+		if (std::holds_alternative<expressions::sum>(e))
+		{
+			for (const auto&term : std::get<expressions::sum>(e)._terms)
+				f(term._variable.absolute_index());
+		}
+		else if (std::holds_alternative<expressions::term>(e))
+			f(std::get<expressions::term>(e)._variable.absolute_index());
+		else if (std::holds_alternative<expressions::variable>(e))
+			f(std::get<expressions::variable>(e).absolute_index());
+	}
+
+	// A counting sort of the indices by block, linking last
+	void partition(const std::vector<int>& blocks, size_t count, std::vector<int>& starts, std::vector<int>& indices)
+	{
+		auto slot = [&](int b) { return b == block_structure::linking ? count : (size_t)b; };
+		starts.assign(count + 2, 0);
+		for (int b : blocks)
+			++starts[slot(b) + 1];
+		for (size_t b = 0; b <= count; ++b)
+			starts[b + 1] += starts[b];
+
+		std::vector<int> next(starts.begin(), starts.end() - 1);
+		indices.resize(blocks.size());
+		for (size_t i = 0; i < blocks.size(); ++i)
+			indices[next[slot(blocks[i])]++] = (int)i;
+	}
+}
+
+namespace milpcpp
+{
+	size_t block_structure::linking_row_count() const
+	{
+		return std::count(_row_block.begin(), _row_block.end(), linking);
+	}
+
+	size_t block_structure::linking_column_count() const
+	{
+		return std::count(_column_block.begin(), _column_block.end(), linking);
+	}
+
+	void block_structure::row_partition(std::vector<int>& starts, std::vector<int>& indices) const
+	{
+		partition(_row_block, _blocks, starts, indices);
+	}
+
+	void block_structure::column_partition(std::vector<int>& starts, std::vector<int>& indices) const
+	{
+		partition(_column_block, _blocks, starts, indices);
+	}
+
+	block_structure model::detect_blocks(std::type_index set) const
+	{
+		if (has_streamed_rows())
+			throw std::logic_error("Cannot detect blocks of rows streamed to a backend");
+
+		block_structure result;
+		result._set = set.name();
+		std::vector<int> variable_block(variable_count(), block_structure::linking);
+		for (const auto&vars : _variable_sets)
+		{
+			size_t stride, size;
+			if (!vars->get_index_layout(set, stride, size))
+				continue;
+			result._blocks = size;
+			size_t start_index = vars->start_index();
+			for (size_t i = 0; i < vars->size(); ++i)
+				variable_block[start_index + i] = (int)(i / stride % size);
+		}
+
+		// Presolved rows refer to the remaining columns
+		result._column_block.resize(column_count());
+		for (size_t j = 0; j < result._column_block.size(); ++j)
+			result._column_block[j] = variable_block[original_index(j)];
+
+		result._row_block.resize(_constraints.size());
+		for (size_t i = 0; i < _constraints.size(); ++i)
+		{
+			int block = block_structure::linking;
+			bool mixed = false;
+			for_each_column(_constraints[i]._expression, [&](size_t column) {
+				int b = result._column_block[column];
+				if (b == block_structure::linking)
+					return;
+				mixed = mixed || (block != block_structure::linking && b != block);
+				block = b;
+			});
+			result._row_block[i] = mixed ? block_structure::linking : block;
+		}
+
+		for (const auto&family : _families)
+		{
+			auto first = result._row_block.begin() + family._first_row;
+			if (std::find(first, first + family._row_count, block_structure::linking) != first + family._row_count)
+				result._linking_families.push_back(family._name);
+		}
+		return result;
+	}
+
+	block_structure model::detect_blocks() const
+	{
+		std::vector<std::type_index> sets;
+		for (const auto&vars : _variable_sets)
+			vars->get_index_sets(sets);
+		std::sort(sets.begin(), sets.end());
+		sets.erase(std::unique(sets.begin(), sets.end()), sets.end());
+
+		block_structure best;
+		size_t best_cost = std::numeric_limits<size_t>::max();
+		for (const auto&set : sets)
+		{
+			block_structure candidate = detect_blocks(set);
+			if (!candidate.decomposable())
+				continue;
+			size_t cost = candidate.linking_row_count() + candidate.linking_column_count();
+			if (cost < best_cost || (cost == best_cost && candidate._blocks > best._blocks))
+			{
+				best = std::move(candidate);
+				best_cost = cost;
+			}
+		}
+		if (!best.decomposable())
+		{
+			best._column_block.assign(column_count(), block_structure::linking);
+			best._row_block.assign(_constraints.size(), block_structure::linking);
+			for (const auto&family : _families)
+			{
+				if (family._row_count != 0)
+					best._linking_families.push_back(family._name);
+			}
+		}
+		return best;
+	}
+}
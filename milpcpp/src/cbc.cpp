@@ -0,0 +1,507 @@
+#include<milpcpp/cbc.h>
+#include<milpcpp/milpcpp.h>
+
+#include <CbcBranchLotsize.hpp>
+#include <CbcEventHandler.hpp>
+#include <CbcModel.hpp>
+#include <CbcSOS.hpp>
+#include <CbcSolver.hpp>
+#include <ClpDualRowDantzig.hpp>
+#include <ClpDualRowSteepest.hpp>
+#include <ClpEventHandler.hpp>
+#include <ClpPrimalColumnDantzig.hpp>
+#include <ClpPrimalColumnSteepest.hpp>
+#include <ClpSimplex.hpp>
+#include <ClpSolve.hpp>
+#include <OsiClpSolverInterface.hpp>
+
+#include"solver_support.h"
+
+#include<algorithm>
+#include<cfloat>
+#include<cmath>
+#include<mutex>
+#include<sstream>
+
+using namespace milpcpp;
+using namespace milpcpp::solver_support;
+
+static_assert(sizeof(CoinBigIndex) == sizeof(int), "CoinUtils must be built with 32 bit CoinBigIndex");
+
+namespace
+{
+	// Shared by the clones CLP and CBC make of the event handlers
+	struct callback_info
+	{
+		solve_control * _control;
+		double _offset;
+		std::mutex _mutex;
+	};
+
+	class clp_events : public ClpEventHandler
+	{
+		callback_info * _info;
+	public:
+		explicit clp_events(callback_info * info) : _info(info) {}
+
+		ClpEventHandler * clone() const override { return new clp_events(*this); }
+
+		// -1 carries on, 0 stops the simplex with status 5
+		int event(Event e) override
+		{
+			if (e != endOfIteration)
+				return -1;
+			std::lock_guard<std::mutex> lock(_info->_mutex);
+			if (_info->_control->cancelled())
+				return 0;
+			if (_info->_control->report_due())
+			{
+				progress p;
+				p._iterations = (size_t)model_->numberIterations();
+				p._objective = model_->objectiveValue() + _info->_offset;
+				_info->_control->report(p);
+			}
+			return -1;
+		}
+	};
+
+	class cbc_events : public CbcEventHandler
+	{
+		callback_info * _info;
+	public:
+		explicit cbc_events(callback_info * info) : _info(info) {}
+
+		CbcEventHandler * clone() const override { return new cbc_events(*this); }
+
+		CbcAction event(CbcEvent e) override
+		{
+			if (e != node && e != solution && e != heuristicSolution)
+				return noAction;
+			std::lock_guard<std::mutex> lock(_info->_mutex);
+			if (_info->_control->cancelled())
+				return stop;
+			if (e == node && !_info->_control->report_due())
+				return noAction;
+
+			progress p;
+			p._nodes = (size_t)model_->getNodeCount();
+			p._iterations = (size_t)model_->getIterationCount();
+			p._bound = model_->getBestPossibleObjValue() + _info->_offset;
+			if (model_->bestSolution())
+			{
+				double objective = model_->getObjValue() + _info->_offset;
+				p._objective = objective;
+				p._mip_gap = std::abs(objective - p._bound.value()) / (std::abs(objective) + DBL_EPSILON);
+			}
+			_info->_control->report(p);
+			return noAction;
+		}
+	};
+
+	int no_callback(CbcModel *, int)
+	{
+		return 0;
+	}
+
+	const char * mode_name(cut_mode mode)
+	{
+		switch (mode)
+		{
+		case cut_mode::off: return "off";
+		case cut_mode::root: return "root";
+		case cut_mode::if_move: return "ifmove";
+		case cut_mode::force_on: return "forceOn";
+		default: return "on";
+		}
+	}
+
+	std::string text(double value)
+	{
+		std::ostringstream out;
+		out.precision(17);
+		out << value;
+		return out.str();
+	}
+
+	// The command line CbcMain1 runs, as the cbc executable would take it
+	std::vector<std::string> arguments(const cbc::options& o)
+	{
+		std::vector<std::string> args{ "milpcpp" };
+		auto add = [&](const char * name, const std::string& value) {
+			args.push_back(std::string("-") + name);
+			args.push_back(value);
+		};
+		auto add_cuts = [&](const char * name, const std::optional<cut_mode>& mode) {
+			if (mode.has_value())
+				add(name, mode_name(mode.value()));
+		};
+		auto add_switch = [&](const char * name, const std::optional<bool>& on) {
+			if (on.has_value())
+				add(name, on.value() ? "on" : "off");
+		};
+
+		if (o._verbose.has_value())
+		{
+			add("log", o._verbose.value() ? "1" : "0");
+			add("slog", o._verbose.value() ? "1" : "0");
+		}
+		if (o._presolve.has_value())
+			add("presolve", o._presolve.value() ? "on" : "off");
+		if (o._threads.has_value())
+			add("threads", std::to_string(o._threads.value()));
+		if (o._time_limit.has_value())
+			add("sec", text(o._time_limit.value()));
+		if (o._mip_gap.has_value())
+			add("ratioGap", text(o._mip_gap.value()));
+		if (o._iteration_limit.has_value())
+			add("maxIterations", std::to_string(o._iteration_limit.value()));
+		switch (o._pricing)
+		{
+		case pricing_rule::dantzig: add("primalPivot", "dantzig"); add("dualPivot", "dantzig"); break;
+		case pricing_rule::devex: add("primalPivot", "exact"); break;
+		case pricing_rule::steepest_edge: add("primalPivot", "steepest"); add("dualPivot", "steepest"); break;
+		default: break;
+		}
+
+		add_cuts("cutsOnOff", o._cuts);
+		add_cuts("gomoryCuts", o._gomory);
+		add_cuts("probingCuts", o._probing);
+		add_cuts("cliqueCuts", o._clique);
+		add_cuts("mixedIntegerRoundingCuts", o._mir);
+		add_cuts("twoMirCuts", o._two_mir);
+		add_cuts("flowCoverCuts", o._flow_cover);
+		add_cuts("knapsackCuts", o._knapsack);
+		add_cuts("zeroHalfCuts", o._zero_half);
+
+		add_switch("heuristicsOnOff", o._heuristics);
+		add_switch("feasibilityPump", o._feasibility_pump);
+		add_switch("Rins", o._rins);
+		add_switch("Rens", o._rens);
+		add_switch("greedyHeuristic", o._greedy);
+
+		for (const auto&[name, value] : o._parameters)
+			add(name.c_str(), value);
+
+		args.push_back("-solve");
+		args.push_back("-quit");
+		return args;
+	}
+
+	solve_status lp_status(ClpSimplex * clp)
+	{
+		switch (clp->status())
+		{
+		case 0: return solve_status::optimal;
+		case 1: return solve_status::infeasible;
+		case 2: return solve_status::unbounded;
+		case 3: return clp->secondaryStatus() == 9 ? solve_status::time_limit : solve_status::iteration_limit;
+		case 5: return solve_status::cancelled;
+		default: return solve_status::failed;
+		}
+	}
+
+	solve_status mip_status(CbcModel& model)
+	{
+		bool solution = model.bestSolution() != nullptr;
+		switch (model.secondaryStatus())
+		{
+		case 0: return solution ? solve_status::optimal : solve_status::infeasible;
+		case 1: return solve_status::infeasible;
+		case 2: return solve_status::feasible;		// within the requested gap
+		case 4: return solve_status::time_limit;
+		case 5: return solve_status::cancelled;
+		case 7: return solve_status::unbounded;
+		case 8: return solve_status::iteration_limit;
+		default: return solution ? solve_status::feasible : solve_status::failed;
+		}
+	}
+
+	// Clp's statuses are 0 free, 1 basic, 2 upper and 3 lower; a fixed column
+	// is at its lower bound
+	const basis_codes clp_basis = { 1, 3, 2, 0, 3 };
+}
+
+cbc::cbc(model * m, const options& o) :backend(m), _mip(false), _warm_start(false), _objective_offset(0), _options(o)
+{
+}
+
+cbc::~cbc()
+{
+}
+
+void cbc::load(const matrix& m)
+{
+	_solver.reset(new OsiClpSolverInterface());
+	_warm_start = false;
+	_cbc.reset();
+	_objects.clear();
+
+	int columns = (int)m._columns;
+	std::vector<int> column_starts, column_indices;
+	std::vector<double> column_values;
+	m.to_columns(column_starts, column_indices, column_values);
+
+	double infinity = _solver->getInfinity();
+	std::vector<double> lower = solver_bounds(m._column_lower, 0, infinity), upper = solver_bounds(m._column_upper, 0, infinity);
+	for (int j = 0; j < (int)m._semicontinuous.size(); ++j)
+	{
+		if (!m._semicontinuous[j])
+			continue;
+		double ranges[] = { 0, 0, m._column_lower[j], m._column_upper[j] };
+		_objects.emplace_back(new CbcLotsize(nullptr, j, 2, ranges, true));
+		lower[j] = 0;
+	}
+	for (size_t k = 0; k < m.sos_count(); ++k)
+	{
+		int start = m._sos_starts[k];
+		_objects.emplace_back(new CbcSOS(nullptr, m._sos_starts[k + 1] - start, m._sos_columns.data() + start,
+			m._sos_weights.data() + start, (int)k, (int)m._sos_types[k]));
+	}
+	std::vector<double> row_lower = solver_bounds(m._row_lower, 0, infinity), row_upper = solver_bounds(m._row_upper, 0, infinity);
+
+	_solver->loadProblem(columns, (int)m.row_count(), column_starts.data(), column_indices.data(), column_values.data(),
+		lower.data(), upper.data(), m._cost.data(), row_lower.data(), row_upper.data());
+	_solver->setObjSense(m._minimize ? 1 : -1);
+	_objective_offset = m._offset;
+
+	std::vector<int> integers;
+	for (int j = 0; j < (int)m._integer.size(); ++j)
+	{
+		if (m._integer[j])
+			integers.push_back(j);
+	}
+	_mip = m.is_mip();
+	if (!integers.empty())
+		_solver->setInteger(integers.data(), (int)integers.size());
+
+	for (size_t j = 0; j < m._names.size(); ++j)
+		_solver->setColName((int)j, m._names[j]);
+}
+
+void cbc::solve_lp()
+{
+	ClpSimplex * clp = _solver->getModelPtr();
+	ClpSolve solve_options;
+	switch (_options._method)
+	{
+	case simplex_method::primal: solve_options.setSolveType(ClpSolve::usePrimal); break;
+	case simplex_method::dual:
+	case simplex_method::dual_then_primal: solve_options.setSolveType(ClpSolve::useDual); break;
+	default: solve_options.setSolveType(ClpSolve::automatic); break;
+	}
+	if (_options._algorithm == lp_algorithm::interior)
+		solve_options.setSolveType(ClpSolve::useBarrier);
+	if (_options._presolve.has_value())
+		solve_options.setPresolveType(_options._presolve.value() ? ClpSolve::presolveOn : ClpSolve::presolveOff);
+	_solver->setSolveOptions(solve_options);
+
+	switch (_options._pricing)
+	{
+	case pricing_rule::dantzig:
+		clp->setDualRowPivotAlgorithm(ClpDualRowDantzig());
+		clp->setPrimalColumnPivotAlgorithm(ClpPrimalColumnDantzig());
+		break;
+	case pricing_rule::devex:
+		clp->setPrimalColumnPivotAlgorithm(ClpPrimalColumnSteepest(0));		// exact devex
+		break;
+	case pricing_rule::steepest_edge:
+		clp->setDualRowPivotAlgorithm(ClpDualRowSteepest(1));
+		clp->setPrimalColumnPivotAlgorithm(ClpPrimalColumnSteepest(1));
+		break;
+	default: break;
+	}
+	if (_options._verbose.has_value())
+	{
+		clp->setLogLevel(_options._verbose.value() ? 1 : 0);
+		_solver->messageHandler()->setLogLevel(_options._verbose.value() ? 1 : 0);
+	}
+	if (_options._iteration_limit.has_value())
+		_solver->setIntParam(OsiMaxNumIteration, _options._iteration_limit.value());
+	if (_options._time_limit.has_value())
+		clp->setMaximumSeconds(_options._time_limit.value());
+
+	// CLP keeps a clone of the handler
+	callback_info info{ &_control, _objective_offset };
+	clp_events events(&info);
+	if (_control.active())
+		clp->passInEventHandler(&events);
+	// resolve() runs the dual simplex from the basis set or left by the last
+	// solve, initialSolve() follows the ClpSolve options
+	if (_warm_start)
+		_solver->resolve();
+	else
+		_solver->initialSolve();
+	_warm_start = true;
+	if (_control.active())
+	{
+		// the clone refers to info
+		ClpEventHandler plain;
+		clp->passInEventHandler(&plain);
+	}
+
+	_result._backend_code = clp->status();
+	_result._status = lp_status(clp);
+	_result._iterations = (size_t)clp->numberIterations();
+	if (_result._status == solve_status::optimal)
+	{
+		_result._objective = _solver->getObjValue() + _objective_offset;
+		const double * values = _solver->getColSolution();
+		_solution._values.assign(values, values + _solver->getNumCols());
+	}
+}
+
+void cbc::solve_mip()
+{
+	_cbc.reset(new CbcModel(*_solver));
+	CbcSolverUsefulData data;
+	CbcMain0(*_cbc, data);
+
+	// addObjects keeps clones
+	std::vector<CbcObject*> objects;
+	for (auto& o : _objects)
+	{
+		o->setModel(_cbc.get());
+		objects.push_back(o.get());
+	}
+	if (!objects.empty())
+		_cbc->addObjects((int)objects.size(), objects.data());
+
+	// CbcMain1 completes and checks the start and says nothing about it
+	// but in its log
+	if (!_start_columns.empty())
+	{
+		std::vector<std::pair<int, double>> start;
+		for (size_t j = 0; j < _start_columns.size(); ++j)
+			start.emplace_back((int)j, _start_columns[j]);
+		_cbc->setMIPStartI(start);
+	}
+
+	callback_info info{ &_control, _objective_offset };
+	cbc_events events(&info);
+	if (_control.active())
+		_cbc->passInEventHandler(&events);
+
+	std::vector<std::string> args = arguments(_options);
+	std::vector<const char*> argv;
+	for (const auto& a : args)
+		argv.push_back(a.c_str());
+	CbcMain1((int)argv.size(), argv.data(), *_cbc, no_callback, data);
+	if (_control.active())
+	{
+		CbcEventHandler plain;
+		_cbc->passInEventHandler(&plain);
+	}
+
+	_result._backend_code = _cbc->status();
+	_result._status = mip_status(*_cbc);
+	_result._iterations = (size_t)_cbc->getIterationCount();
+	_result._nodes = (size_t)_cbc->getNodeCount();
+	if (const double * values = _cbc->bestSolution())
+	{
+		_result._objective = _cbc->getObjValue() + _objective_offset;
+		_solution._values.assign(values, values + _cbc->getNumCols());
+	}
+
+	if (!_start_columns.empty())
+		_result._start_accepted = _cbc->getNumberSolutions() > 0 && kept_start();
+}
+
+void cbc::run()
+{
+	if (_control.cancelled())
+	{
+		_result._status = solve_status::cancelled;
+		return;
+	}
+	_control.start();
+	if (_mip)
+		solve_mip();
+	else
+		solve_lp();
+}
+
+void cbc::get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns)
+{
+	if (_mip)
+		return;
+	std::vector<int> column_status(_solver->getNumCols()), row_status(_solver->getNumRows());
+	_solver->getBasisStatus(column_status.data(), row_status.data());
+	columns = from_solver_basis(column_status, clp_basis, basis_status::lower);
+	rows = from_solver_basis(row_status, clp_basis, basis_status::lower);
+}
+
+// CLP keeps its basis, an LP solved before goes on from it with resolve();
+// a MIP is handed to a new CbcModel anyway
+bool cbc::append_rows(const matrix& m, size_t first_row, size_t loaded_rows)
+{
+	if (!_solver || _solver->getNumRows() != (int)loaded_rows || _solver->getNumCols() != (int)m._columns)
+		return false;
+	int rows = (int)(m.row_count() - first_row);
+	if (rows == 0)
+		return true;
+	double infinity = _solver->getInfinity();
+	std::vector<double> lower = solver_bounds(m._row_lower, first_row, infinity), upper = solver_bounds(m._row_upper, first_row, infinity);
+	int offset = m._row_starts[first_row];
+	std::vector<CoinBigIndex> starts(m._row_starts.begin() + first_row, m._row_starts.end());
+	for (CoinBigIndex& s : starts)
+		s -= offset;
+	_solver->addRows(rows, starts.data(), m._row_indices.data() + offset, m._row_values.data() + offset, lower.data(), upper.data());
+	return true;
+}
+
+bool cbc::set_objective(const matrix& m)
+{
+	if (!_solver || _solver->getNumCols() != (int)m._columns)
+		return false;
+	_solver->setObjective(m._cost.data());
+	_solver->setObjSense(m._minimize ? 1 : -1);
+	_objective_offset = m._offset;
+	return true;
+}
+
+// The ranges of a CbcLotsize stay as they were loaded
+bool cbc::change_column_bounds(const matrix& m, const std::vector<int>& columns)
+{
+	if (!_solver || _solver->getNumCols() != (int)m._columns || m.has_semicontinuous())
+		return false;
+	double infinity = _solver->getInfinity();
+	for (int j : columns)
+	{
+		_solver->setColBounds(j,
+			m._column_lower[j] == -matrix::infinity ? -infinity : m._column_lower[j],
+			m._column_upper[j] == matrix::infinity ? infinity : m._column_upper[j]);
+	}
+	return true;
+}
+
+bool cbc::change_column_types(const matrix& m, const std::vector<int>& columns)
+{
+	if (!_solver || _solver->getNumCols() != (int)m._columns)
+		return false;
+	for (int j : columns)
+	{
+		if (m.has_integers() && m._integer[j])
+			_solver->setInteger(j);
+		else
+			_solver->setContinuous(j);
+	}
+	_mip = m.is_mip();
+	return true;
+}
+
+void cbc::get_duals(std::vector<double>& rows)
+{
+	if (!_solver || _mip)
+		return;
+	const double * duals = _solver->getRowPrice();
+	rows.assign(duals, duals + _solver->getNumRows());
+}
+
+void cbc::set_basis(const std::vector<basis_status>& rows, const std::vector<basis_status>& columns)
+{
+	if (_mip)
+		return;
+	std::vector<int> column_status = to_solver_basis(columns, clp_basis), row_status = to_solver_basis(rows, clp_basis);
+	_solver->setBasisStatus(column_status.data(), row_status.data());
+	_warm_start = true;
+}
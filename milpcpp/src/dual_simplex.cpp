@@ -0,0 +1,364 @@
+#include<milpcpp/dual_simplex.h>
+
+#include<algorithm>
+#include<cmath>
+#include<stdexcept>
+
+using namespace milpcpp;
+
+dual_simplex::dual_simplex(model * m, const options& o) :backend(m), _options(o)
+{
+}
+
+void dual_simplex::load(const matrix& m)
+{
+	if (m.has_integers() && std::find(m._integer.begin(), m._integer.end(), 1) != m._integer.end())
+		throw std::invalid_argument("dual_simplex solves LPs only");
+
+	_rows = m.row_count();
+	_columns = m._columns;
+	size_t variables = _columns + _rows;
+	_sign = m._minimize ? 1 : -1;
+	_offset = m._offset;
+
+	// resize and assign keep the capacity, a model no larger than the last
+	// one reuses the workspace
+	_tableau.assign(_rows * variables, 0);
+	_lower.resize(variables);
+	_upper.resize(variables);
+	_boxed.assign(variables, 0);
+	_cost.assign(variables, 0);
+	_reduced_cost.resize(variables);
+	_value.resize(variables);
+	_position.resize(variables);
+	_head.resize(_rows);
+
+	std::copy(m._column_lower.begin(), m._column_lower.end(), _lower.begin());
+	std::copy(m._column_upper.begin(), m._column_upper.end(), _upper.begin());
+	std::copy(m._row_lower.begin(), m._row_lower.end(), _lower.begin() + _columns);
+	std::copy(m._row_upper.begin(), m._row_upper.end(), _upper.begin() + _columns);
+	for (size_t j = 0; j < _columns; ++j)
+		_cost[j] = _sign * m._cost[j];
+
+	// The slacks form the first basis, B = -I, so the tableau is [-A I]
+	for (size_t i = 0; i < _rows; ++i)
+	{
+		for (int k = m._row_starts[i]; k < m._row_starts[i + 1]; ++k)
+			at(i, m._row_indices[k]) -= m._row_values[k];
+		at(i, _columns + i) = 1;
+		_head[i] = (int)(_columns + i);
+	}
+}
+
+// The most infeasible basic variable, weighted by the norm of its row of
+// B^-1 for dual steepest edge
+int dual_simplex::leaving_row() const
+{
+	size_t variables = _columns + _rows;
+	bool dantzig = _options._pricing == pricing_rule::dantzig;
+	int best = -1;
+	double best_score = 0;
+	for (size_t i = 0; i < _rows; ++i)
+	{
+		int p = _head[i];
+		double infeasibility = 0;
+		if (_value[p] < _lower[p] - _options._primal_tolerance)
+			infeasibility = _lower[p] - _value[p];
+		else if (_value[p] > _upper[p] + _options._primal_tolerance)
+			infeasibility = _value[p] - _upper[p];
+		else
+			continue;
+
+		double score = infeasibility;
+		if (!dantzig)
+		{
+			const double * row = &_tableau[i * variables + _columns];
+			double weight = 0;
+			for (size_t k = 0; k < _rows; ++k)
+				weight += row[k] * row[k];
+			score = infeasibility * infeasibility / weight;
+		}
+		if (score > best_score)
+		{
+			best_score = score;
+			best = (int)i;
+		}
+	}
+	return best;
+}
+
+// Harris' two pass ratio test on the row of the leaving variable. increase
+// tells whether that variable has to grow to reach its bound.
+int dual_simplex::entering_column(int row, bool increase) const
+{
+	size_t variables = _columns + _rows;
+	const double * alpha_row = &_tableau[row * variables];
+	double direction = increase ? -1 : 1;	// the basic value moves by -alpha * step
+
+	// How far each candidate's reduced cost allows the dual step to go
+	auto candidate = [&](size_t j, double& alpha, double& slack) {
+		if (_position[j] == position::basic || _lower[j] == _upper[j])
+			return false;
+		alpha = direction * alpha_row[j];
+		switch (_position[j])
+		{
+		case position::lower:
+			if (alpha <= _options._pivot_tolerance)
+				return false;
+			slack = std::max(_reduced_cost[j], 0.0);
+			break;
+		case position::upper:
+			if (alpha >= -_options._pivot_tolerance)
+				return false;
+			slack = std::max(-_reduced_cost[j], 0.0);
+			break;
+		default:
+			if (std::abs(alpha) <= _options._pivot_tolerance)
+				return false;
+			slack = std::abs(_reduced_cost[j]);
+			break;
+		}
+		alpha = std::abs(alpha);
+		return true;
+	};
+
+	double bound = HUGE_VAL;
+	double alpha, slack;
+	for (size_t j = 0; j < variables; ++j)
+	{
+		if (candidate(j, alpha, slack))
+			bound = std::min(bound, (slack + _options._dual_tolerance) / alpha);
+	}
+	if (bound == HUGE_VAL)
+		return -1;
+
+	int best = -1;
+	double best_alpha = 0;
+	for (size_t j = 0; j < variables; ++j)
+	{
+		if (candidate(j, alpha, slack) && slack / alpha <= bound && alpha > best_alpha)
+		{
+			best_alpha = alpha;
+			best = (int)j;
+		}
+	}
+	return best;
+}
+
+// Moves column into the basis in place of the variable of row, which goes
+// to target, one of its bounds
+void dual_simplex::pivot(int row, int column, double target)
+{
+	size_t variables = _columns + _rows;
+	double * pivot_row = &_tableau[row * variables];
+	double alpha = pivot_row[column];
+	int leaving = _head[row];
+
+	double step = (_value[leaving] - target) / alpha;
+	for (size_t i = 0; i < _rows; ++i)
+		_value[_head[i]] -= at(i, column) * step;
+	_value[column] += step;
+	_value[leaving] = target;
+
+	double theta = _reduced_cost[column] / alpha;
+	for (size_t j = 0; j < variables; ++j)
+		_reduced_cost[j] -= theta * pivot_row[j];
+	_reduced_cost[column] = 0;
+
+	for (size_t j = 0; j < variables; ++j)
+		pivot_row[j] /= alpha;
+	for (size_t i = 0; i < _rows; ++i)
+	{
+		if (i == (size_t)row)
+			continue;
+		double * other = &_tableau[i * variables];
+		double factor = other[column];
+		if (factor == 0)
+			continue;
+		for (size_t j = 0; j < variables; ++j)
+			other[j] -= factor * pivot_row[j];
+		other[column] = 0;
+	}
+
+	_head[row] = column;
+	_position[column] = position::basic;
+	_position[leaving] = target == _lower[leaving] ? position::lower : position::upper;
+}
+
+// x_B = -B^-1 N x_N, from scratch to drop the drift of the updates
+void dual_simplex::compute_basic_values()
+{
+	size_t variables = _columns + _rows;
+	for (size_t i = 0; i < _rows; ++i)
+	{
+		const double * row = &_tableau[i * variables];
+		double value = 0;
+		for (size_t j = 0; j < variables; ++j)
+		{
+			if (_position[j] != position::basic)
+				value -= row[j] * _value[j];
+		}
+		_value[_head[i]] = value;
+	}
+}
+
+void dual_simplex::run()
+{
+	_control.start();
+	if (_control.cancelled())
+	{
+		_result._status = solve_status::cancelled;
+		return;
+	}
+	size_t variables = _columns + _rows;
+
+	// A dual feasible start: each column on the bound its cost points to,
+	// boxed when that bound is missing
+	for (size_t j = 0; j < variables; ++j)
+	{
+		_reduced_cost[j] = _cost[j];
+		if (j >= _columns)
+		{
+			_position[j] = position::basic;
+			continue;
+		}
+		bool lower = std::isfinite(_lower[j]), upper = std::isfinite(_upper[j]);
+		if (_cost[j] > 0 || (_cost[j] == 0 && lower))
+		{
+			if (!lower)
+			{
+				_lower[j] = -_options._box;
+				_boxed[j] = 1;
+			}
+			_position[j] = position::lower;
+			_value[j] = _lower[j];
+		}
+		else if (_cost[j] < 0 || upper)
+		{
+			if (!upper)
+			{
+				_upper[j] = _options._box;
+				_boxed[j] = 1;
+			}
+			_position[j] = position::upper;
+			_value[j] = _upper[j];
+		}
+		else
+		{
+			_position[j] = position::zero;
+			_value[j] = 0;
+		}
+	}
+	compute_basic_values();
+
+	size_t limit = _options._iteration_limit.has_value() ?
+		(size_t)_options._iteration_limit.value() : 50 * variables + 1000;
+	size_t iterations = 0;
+	solve_status status = solve_status::optimal;
+	for (;; ++iterations)
+	{
+		int row = leaving_row();
+		if (row < 0)
+			break;
+		if (iterations >= limit)
+		{
+			status = solve_status::iteration_limit;
+			break;
+		}
+		if (iterations % 64 == 63 && _control.active())
+		{
+			if (_control.cancelled())
+			{
+				status = solve_status::cancelled;
+				break;
+			}
+			if (_control.report_due())
+			{
+				progress p;
+				p._iterations = iterations;
+				_control.report(p);
+			}
+		}
+		if (iterations % 64 == 63 && _options._time_limit.has_value() && _control.elapsed() > _options._time_limit.value())
+		{
+			status = solve_status::time_limit;
+			break;
+		}
+
+		int p = _head[row];
+		bool increase = _value[p] < _lower[p];
+		int column = entering_column(row, increase);
+		if (column < 0)
+		{
+			// The row proves infeasibility unless a boxed column could help
+			// by going past its box
+			status = solve_status::infeasible;
+			const double * alpha_row = &_tableau[row * variables];
+			for (size_t j = 0; j < _columns; ++j)
+			{
+				double alpha = (increase ? -1 : 1) * alpha_row[j];
+				if (_boxed[j] && _position[j] == position::lower && _lower[j] == -_options._box && alpha < -_options._pivot_tolerance)
+					status = solve_status::failed;
+				if (_boxed[j] && _position[j] == position::upper && _upper[j] == _options._box && alpha > _options._pivot_tolerance)
+					status = solve_status::failed;
+			}
+			break;
+		}
+		pivot(row, column, increase ? _lower[p] : _upper[p]);
+	}
+	compute_basic_values();
+
+	_result._status = status;
+	_result._iterations = iterations;
+	if (status != solve_status::optimal)
+		return;
+
+	// Pushing a column past its box would still improve the objective
+	for (size_t j = 0; j < _columns; ++j)
+	{
+		bool at_box = (_position[j] == position::lower && _lower[j] == -_options._box) ||
+			(_position[j] == position::upper && _upper[j] == _options._box);
+		if (_boxed[j] && at_box && std::abs(_reduced_cost[j]) > _options._dual_tolerance)
+		{
+			_result._status = solve_status::unbounded;
+			return;
+		}
+	}
+
+	double objective = 0;
+	for (size_t j = 0; j < _columns; ++j)
+		objective += _cost[j] * _value[j];
+	_result._objective = _sign * objective + _offset;
+	_solution._values.assign(_value.begin(), _value.begin() + _columns);
+}
+
+// The reduced cost of a row's slack, which carries the row's bounds
+void dual_simplex::get_duals(std::vector<double>& rows)
+{
+	if (_result._status != solve_status::optimal)
+		return;
+	rows.resize(_rows);
+	for (size_t i = 0; i < _rows; ++i)
+		rows[i] = _sign * _reduced_cost[_columns + i];
+}
+
+void dual_simplex::get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns)
+{
+	auto status = [this](size_t j) {
+		switch (_position[j])
+		{
+		case position::basic: return basis_status::basic;
+		case position::zero: return basis_status::free;
+		default:
+			if (_lower[j] == _upper[j])
+				return basis_status::fixed;
+			return _position[j] == position::lower ? basis_status::lower : basis_status::upper;
+		}
+	};
+	columns.resize(_columns);
+	for (size_t j = 0; j < _columns; ++j)
+		columns[j] = status(j);
+	rows.resize(_rows);
+	for (size_t i = 0; i < _rows; ++i)
+		rows[i] = status(_columns + i);
+}
@@ -0,0 +1,188 @@
+#include<milpcpp/model.h>
+
+#include<atomic>
+#include<future>
+#include<thread>
+#include<variant>
+
+using namespace milpcpp;
+
+namespace
+{
+	// Fixed, so the digest does not depend on the number of threads
+	const size_t chunk_size = 4096;
+
+	void hash_expression(hasher& h, const expression& e)
+	{
+		if (std::holds_alternative<expressions::sum>(e))
+		{
+			const auto& sum = std::get<expressions::sum>(e);
+			h.add((uint64_t)sum._terms.size());
+			for (const auto& t : sum._terms)
+			{
+				h.add((uint64_t)t._variable._index);
+				h.add(t._coefficient._value);
+			}
+			h.add(sum._constant_term._value);
+		}
+		else if (std::holds_alternative<expressions::term>(e))
+		{
+			const auto& t = std::get<expressions::term>(e);
+			h.add((uint64_t)1);
+			h.add((uint64_t)t._variable._index);
+			h.add(t._coefficient._value);
+			h.add(0.0);
+		}
+		else if (std::holds_alternative<expressions::variable>(e))
+		{
+			h.add((uint64_t)1);
+			h.add((uint64_t)std::get<expressions::variable>(e)._index);
+			h.add(1.0);
+			h.add(0.0);
+		}
+		else
+		{
+			h.add((uint64_t)0);
+			h.add(std::holds_alternative<expressions::constant>(e) ? std::get<expressions::constant>(e)._value : 0.0);
+		}
+	}
+
+	void hash_constraint(hasher& h, const constraint& c)
+	{
+		hash_expression(h, c._expression);
+		h.add(c._lower_bound.has_value());
+		h.add(c._lower_bound.value_or(0));
+		h.add(c._upper_bound.has_value());
+		h.add(c._upper_bound.value_or(0));
+	}
+
+	size_t chunk_count(size_t size) { return (size + chunk_size - 1) / chunk_size; }
+
+	// Runs job(i) for every i in [0, count) on up to one thread per core
+	template<typename F>
+	void parallel_for(size_t count, F job)
+	{
+		size_t threads = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+		std::atomic<size_t> next{ 0 };
+		auto worker = [&]() {
+			for (size_t i = next++; i < count; i = next++)
+				job(i);
+		};
+		std::vector<std::future<void>> helpers;
+		for (size_t t = 1; t < threads; ++t)
+			helpers.push_back(std::async(std::launch::async, worker));
+		worker();
+		for (auto& f : helpers)
+			f.get();
+	}
+}
+
+fingerprint model::compute_fingerprint()
+{
+	if (has_streamed_rows())
+		throw std::logic_error("Cannot fingerprint a model whose rows were streamed to a backend");
+
+	// Row ranges still to hash: the families without an up to date digest,
+	// or all rows once presolve has merged the families
+	struct range
+	{
+		size_t _first;
+		size_t _count;
+		constraint_family * _family;
+		fingerprint _digest;
+	};
+	std::vector<range> ranges;
+	if (_families.empty())
+		ranges.push_back(range{ 0, _constraints.size(), nullptr });
+	for (auto& f : _families)
+	{
+		if (f._hashed_rows != f._row_count)
+			ranges.push_back(range{ f._first_row, f._row_count, &f });
+	}
+
+	// A job is a chunk of the columns or of one range
+	struct job
+	{
+		size_t _range;			// ranges.size() for columns
+		size_t _first;
+		size_t _last;
+	};
+	std::vector<job> jobs;
+	size_t columns = column_count();
+	for (size_t first = 0; first < columns; first += chunk_size)
+		jobs.push_back(job{ ranges.size(), first, std::min(columns, first + chunk_size) });
+	for (size_t r = 0; r < ranges.size(); ++r)
+	{
+		for (size_t first = 0; first < ranges[r]._count; first += chunk_size)
+			jobs.push_back(job{ r, ranges[r]._first + first, ranges[r]._first + std::min(ranges[r]._count, first + chunk_size) });
+	}
+
+	std::vector<fingerprint> digests(jobs.size());
+	parallel_for(jobs.size(), [&](size_t i) {
+		const auto& j = jobs[i];
+		hasher h;
+		if (j._range == ranges.size() && _postsolve.active())
+		{
+			for (size_t column = j._first; column < j._last; ++column)
+			{
+				h.add(has_lower_bound(column));
+				h.add(has_lower_bound(column) ? get_lower_bound(column) : 0.0);
+				h.add(has_upper_bound(column));
+				h.add(has_upper_bound(column) ? get_upper_bound(column) : 0.0);
+				h.add(is_integer(column));
+			}
+		}
+		else if (j._range == ranges.size())
+		{
+			for_each_variable(j._first, j._last, [&](const variable_set& set, size_t column) {
+				bool lower = set.has_lower_bound(), upper = set.has_upper_bound();
+				h.add(lower);
+				h.add(lower ? set.get_lower_bound(column) : 0.0);
+				h.add(upper);
+				h.add(upper ? set.get_upper_bound(column) : 0.0);
+				h.add(set.is_integer());
+			});
+		}
+		else
+		{
+			for (size_t row = j._first; row < j._last; ++row)
+				hash_constraint(h, _constraints[row]);
+		}
+		digests[i] = h.digest();
+	});
+
+	// Jobs are in column, then range order, so the chunk digests of a range are contiguous
+	size_t next = chunk_count(columns);
+	for (auto& r : ranges)
+	{
+		hasher h;
+		h.add((uint64_t)r._count);
+		for (size_t c = chunk_count(r._count); c > 0; --c)
+			h.add(digests[next++]);
+		r._digest = h.digest();
+		if (r._family)
+		{
+			r._family->_fingerprint = r._digest;
+			r._family->_hashed_rows = r._count;
+		}
+	}
+
+	hasher h;
+	h.add((uint64_t)columns);
+	for (size_t c = 0; c < chunk_count(columns); ++c)
+		h.add(digests[c]);
+	h.add((uint64_t)_constraints.size());
+	if (_families.empty())
+		h.add(ranges.front()._digest);
+	for (const auto& f : _families)
+		h.add(f._fingerprint);
+	hash_expression(h, _objective);
+	h.add(_minimize);
+	for (const variable_set * set : _variable_sets)
+	{
+		h.add(set->is_semicontinuous());
+		h.add(set->has_sos() ? (uint64_t)set->get_sos_type() : 0);
+		h.add((uint64_t)set->sos_component());
+	}
+	return h.digest();
+}
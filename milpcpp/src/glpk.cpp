@@ -1,168 +1,517 @@
 #include<milpcpp/glpk.h>
 #include<milpcpp/milpcpp.h>
 
-#include <milpcpp/enumerate.h>
-
 #include <glpk.h>
 
-#include<variant>
+#include<algorithm>
+#include<climits>
+#include<cstdio>
+#include<vector>
 
 using namespace milpcpp;
 
-glpk::glpk(model * m) :_model(m)
-{
-}
-
-glpk::~glpk()
-{
-	glp_delete_prob(_lp);
-}
-
-double glpk::get_variable_value(size_t absolute_index)
+namespace
 {
-	return glp_get_col_prim(_lp, (int) absolute_index + 1);
-}
+	int message_level(const solver_options& o, int level)
+	{
+		if (!o._verbose.has_value())
+			return level;
+		return o._verbose.value() ? GLP_MSG_ON : GLP_MSG_ERR;
+	}
 
+	int milliseconds(double seconds)
+	{
+		return (int)std::min(seconds * 1000, (double)INT_MAX);
+	}
 
-void glpk::solve()
-{
-	_lp = glp_create_prob();
-	int var_count = (int)_model->variable_count();
+	void set_parameters(glp_smcp& parm, const glpk::options& o)
+	{
+		parm.msg_lev = message_level(o, parm.msg_lev);
+		switch (o._method)
+		{
+		case simplex_method::primal: parm.meth = GLP_PRIMAL; break;
+		case simplex_method::dual: parm.meth = GLP_DUAL; break;
+		case simplex_method::dual_then_primal: parm.meth = GLP_DUALP; break;
+		default: break;
+		}
+		switch (o._pricing)
+		{
+		case pricing_rule::dantzig: parm.pricing = GLP_PT_STD; break;
+		case pricing_rule::devex:
+		case pricing_rule::steepest_edge: parm.pricing = GLP_PT_PSE; break;
+		default: break;
+		}
+		parm.r_test = o._harris_ratio_test ? GLP_RT_HAR : GLP_RT_STD;
+		if (o._presolve.has_value())
+			parm.presolve = o._presolve.value() ? GLP_ON : GLP_OFF;
+		if (o._iteration_limit.has_value())
+			parm.it_lim = o._iteration_limit.value();
+		if (o._time_limit.has_value())
+			parm.tm_lim = milliseconds(o._time_limit.value());
+	}
 
-	glp_add_cols(_lp, var_count);
+	void set_parameters(glp_iocp& parm, const glpk::options& o)
+	{
+		parm.msg_lev = message_level(o, parm.msg_lev);
+		if (o._time_limit.has_value())
+			parm.tm_lim = milliseconds(o._time_limit.value());
+		if (o._mip_gap.has_value())
+			parm.mip_gap = o._mip_gap.value();
+	}
 
-	for (int i = 1; i <= var_count; ++i)
+	solve_status simplex_status(int code, glp_prob * lp)
 	{
-		glp_set_col_kind(_lp, i, GLP_CV);
-		glp_set_col_name(_lp, i, _model->variable_name(i - 1).c_str());
-		if (_model->has_lower_bound(i-1) && _model->has_upper_bound(i-1))
+		switch (code)
 		{
-			glp_set_col_bnds(_lp, i, GLP_DB, 
-				_model->get_lower_bound(i-1), 
-				_model->get_upper_bound(i-1));
+		case 0: break;
+		case GLP_ETMLIM: return solve_status::time_limit;
+		case GLP_EITLIM: return solve_status::iteration_limit;
+		case GLP_ESTOP: return solve_status::cancelled;
+		case GLP_ENOPFS: return solve_status::infeasible;
+		case GLP_ENODFS: return solve_status::infeasible_or_unbounded;
+		default: return solve_status::failed;
 		}
-		else if(_model->has_lower_bound(i-1))
+		switch (glp_get_status(lp))
 		{
-			glp_set_col_bnds(_lp, i, GLP_LO,
-				_model->get_lower_bound(i-1),
-				0);
+		case GLP_OPT: return solve_status::optimal;
+		case GLP_FEAS: return solve_status::feasible;
+		case GLP_INFEAS:
+		case GLP_NOFEAS: return solve_status::infeasible;
+		case GLP_UNBND: return solve_status::unbounded;
+		default: return solve_status::failed;
 		}
-		else if (_model->has_upper_bound(i-1))
+	}
+
+	solve_status interior_status(int code, glp_prob * lp)
+	{
+		switch (code)
 		{
-			glp_set_col_bnds(_lp, i, GLP_UP,
-				0,
-				_model->get_upper_bound(i-1));
+		case 0: break;
+		case GLP_EITLIM: return solve_status::iteration_limit;
+		case GLP_ENOFEAS: return solve_status::infeasible_or_unbounded;
+		default: return solve_status::failed;
 		}
-		else
+		switch (glp_ipt_status(lp))
 		{
-			glp_set_col_bnds(_lp, i, GLP_FR, 0, 0);
+		case GLP_OPT: return solve_status::optimal;
+		case GLP_INFEAS:
+		case GLP_NOFEAS: return solve_status::infeasible;
+		default: return solve_status::failed;
 		}
-
 	}
 
-	glp_add_rows(_lp, (int)_model->_constraints.size());
+	solve_status mip_status(int code, glp_prob * lp)
+	{
+		switch (code)
+		{
+		case 0: break;
+		case GLP_ETMLIM: return solve_status::time_limit;
+		case GLP_EMIPGAP: return solve_status::feasible;	// within the requested gap
+		case GLP_ESTOP: return solve_status::cancelled;
+		case GLP_ENOPFS: return solve_status::infeasible;
+		case GLP_ENODFS: return solve_status::infeasible_or_unbounded;
+		default: return solve_status::failed;
+		}
+		switch (glp_mip_status(lp))
+		{
+		case GLP_OPT: return solve_status::optimal;
+		case GLP_FEAS: return solve_status::feasible;
+		case GLP_NOFEAS: return solve_status::infeasible;
+		default: return solve_status::failed;
+		}
+	}
 
-	int current_row = 0;
-	for (const auto & c : _model->_constraints)
+	struct callback_info
 	{
-		++current_row;
+		solve_control * _control;
+		bool _verbose;
+		bool _cancelled;
+		size_t _nodes;
+		const double * _start;	// 1 based MIP start, null once offered
+		bool _start_accepted;
+	};
 
-		int type;
-		if (c._lower_bound.has_value() && c._upper_bound.has_value())
+	// Receives everything glpk prints; the simplex prints a line like
+	// "*   123: obj =   1.5e+03 inf =   0.0e+00 (2)" every out_frq.
+	int terminal_hook(void * info, const char * s)
+	{
+		auto callback = (callback_info*)info;
+		int iterations;
+		double objective;
+		if (std::sscanf(s, "%*[ *]%d: obj = %lf", &iterations, &objective) == 2)
 		{
-			if(c._lower_bound >= c._upper_bound)
-				type = GLP_FX;
-			else
-				type = GLP_DB;
+			progress p;
+			p._iterations = (size_t)iterations;
+			p._objective = objective;
+			callback->_control->report(p);
 		}
-		else if (c._upper_bound.has_value())
+		return callback->_verbose ? 0 : 1;
+	}
+
+	void branch_hook(glp_tree * tree, void * info)
+	{
+		auto callback = (callback_info*)info;
+		int reason = glp_ios_reason(tree);
+		if (reason == GLP_IHEUR && callback->_start)
 		{
-			type = GLP_UP;
+			// Offered once, at the first node; glpk takes it if it is better
+			// than an incumbent of its own
+			callback->_start_accepted = glp_ios_heur_sol(tree, callback->_start) == 0;
+			callback->_start = nullptr;
+			return;
 		}
-		else if (c._lower_bound.has_value())
+		if (reason != GLP_ISELECT && reason != GLP_IBINGO)
+			return;
+		int nodes;
+		glp_ios_tree_size(tree, nullptr, nullptr, &nodes);
+		callback->_nodes = (size_t)nodes;
+		if (!callback->_control->active())
+			return;
+		if (callback->_control->cancelled())
 		{
-			type = GLP_LO;
+			callback->_cancelled = true;
+			glp_ios_terminate(tree);
+			return;
 		}
-		else
+		if (reason != GLP_IBINGO && !callback->_control->report_due())
+			return;
+
+		glp_prob * lp = glp_ios_get_prob(tree);
+		progress p;
+		p._nodes = (size_t)nodes;
+		p._iterations = (size_t)glp_get_it_cnt(lp);
+		if (glp_mip_status(lp) == GLP_FEAS || glp_mip_status(lp) == GLP_OPT)
 		{
-			type = GLP_FR;
+			p._objective = glp_mip_obj_val(lp);
+			p._mip_gap = glp_ios_mip_gap(tree);
 		}
+		int best = glp_ios_best_node(tree);
+		if (best != 0)
+			p._bound = glp_ios_node_bound(tree, best);
+		callback->_control->report(p);
+	}
 
-		const auto & e = c._expression;
+	// The simplex has no callback to stop it, so an interruptible one runs
+	// in slices, each call going on from the basis the last one left, and
+	// checks for cancellation in between. Each slice is sized from the speed
+	// of the last to take about slice_seconds, which keeps restarts rare. The
+	// presolver keeps no basis to go on from and is left off.
+	const int first_slice = 1000;
+	const double slice_seconds = 0.25;
 
-		if (std::holds_alternative<expressions::sum>(e))
+	int sliced_simplex(glp_prob * lp, glp_smcp parm, solve_control& control)
+	{
+		const int iteration_limit = parm.it_lim, time_limit = parm.tm_lim;
+		const int start = glp_get_it_cnt(lp);
+		parm.presolve = GLP_OFF;
+		int slice = first_slice;
+		for (;;)
 		{
-			const auto&sum = std::get<expressions::sum>(e);
-			double lower = c._lower_bound.value_or(0) - sum._constant_term._value;
-			double upper = c._upper_bound.value_or(0) - sum._constant_term._value;
-			int size = (int)sum._terms.size();
-			std::vector<int> indices(size + 1);
-			std::vector<double> values(size + 1);
+			int before = glp_get_it_cnt(lp);
+			double before_time = control.elapsed();
+			parm.it_lim = std::min(slice, iteration_limit - (before - start));
+			if (time_limit != INT_MAX)
+				parm.tm_lim = std::max(0, time_limit - (int)(before_time * 1000));
+			int code = glp_simplex(lp, &parm);
+			if (code != GLP_EITLIM || glp_get_it_cnt(lp) - start >= iteration_limit)
+				return code;
+			if (control.cancelled())
+				return GLP_ESTOP;
+			double seconds = std::max(control.elapsed() - before_time, 1e-6);
+			double rate = (glp_get_it_cnt(lp) - before) / seconds;
+			slice = (int)std::min(std::max(rate * slice_seconds, (double)first_slice), (double)(INT_MAX / 2));
+		}
+	}
 
-			auto terms = // range/iterator of (variable index, coeffient) pairs
-				sum._terms | 
-				ranges::view::transform([](auto e) { 
-					return std::make_pair(e.first, e.second._coefficient._value);
-				});
+	void set_column_bounds(glp_prob * lp, int column, double lower, double upper)
+	{
+		bool has_lower = lower != -matrix::infinity, has_upper = upper != matrix::infinity;
+		int type;
+		if (has_lower && has_upper)
+			type = lower >= upper ? GLP_FX : GLP_DB;
+		else
+			type = has_lower ? GLP_LO : has_upper ? GLP_UP : GLP_FR;
+		glp_set_col_bnds(lp, column, type, has_lower ? lower : 0, has_upper ? upper : 0);
+	}
 
-			for (const auto&[current_index, term ] : utils::enumerate(terms))
-			{
-				const auto&[index, value] = term;
-				indices[current_index+1] = (int)index + 1;
-				values[current_index+1] = value;
-			}
-			glp_set_row_bnds(_lp, current_row , type, lower, upper);
-			glp_set_mat_row(_lp, current_row, size, &indices[0], &values[0]);
+	void set_row_bounds(glp_prob * lp, int row, double lower, double upper)
+	{
+		bool has_lower = lower != -matrix::infinity, has_upper = upper != matrix::infinity;
+		int type;
+		if (has_lower && has_upper)
+			type = lower >= upper ? GLP_FX : GLP_DB;
+		else
+			type = has_lower ? GLP_LO : has_upper ? GLP_UP : GLP_FR;
+		glp_set_row_bnds(lp, row, type, has_lower ? lower : 0, has_upper ? upper : 0);
+	}
+}
 
+glpk::glpk(model * m, const options& o) :backend(m), _lp(nullptr), _options(o), _kind(solution::basic), _mip(false)
+{
+}
+
+glpk::~glpk()
+{
+	if (_lp)
+		glp_delete_prob(_lp);
+}
+
+void glpk::load(const matrix& m)
+{
+	if (_lp)
+		glp_delete_prob(_lp);
+	_lp = glp_create_prob();
+	_mip = m.has_integers();
+
+	int columns = (int)m._columns;
+	if (columns > 0)
+		glp_add_cols(_lp, columns);
+	for (int j = 0; j < columns; ++j)
+	{
+		set_column_bounds(_lp, j + 1, m._column_lower[j], m._column_upper[j]);
+		if (m.has_integers() && m._integer[j])
+			glp_set_col_kind(_lp, j + 1, GLP_IV);
+		if (!m._names.empty())
+			glp_set_col_name(_lp, j + 1, m._names[j].c_str());
+		if (m._cost[j] != 0)
+			glp_set_obj_coef(_lp, j + 1, m._cost[j]);
+	}
+	glp_set_obj_coef(_lp, 0, m._offset);
+	glp_set_obj_dir(_lp, m._minimize ? GLP_MIN : GLP_MAX);
+
+	int rows = (int)m.row_count();
+	if (rows > 0)
+		glp_add_rows(_lp, rows);
+	for (int i = 0; i < rows; ++i)
+		set_row_bounds(_lp, i + 1, m._row_lower[i], m._row_upper[i]);
+
+	// glp_load_matrix takes 1 based triplets
+	int nonzeros = (int)m.nonzero_count();
+	std::vector<int> row_indices(nonzeros + 1), column_indices(nonzeros + 1);
+	std::vector<double> values(nonzeros + 1);
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int k = m._row_starts[i]; k < m._row_starts[i + 1]; ++k)
+		{
+			row_indices[k + 1] = i + 1;
+			column_indices[k + 1] = m._row_indices[k] + 1;
+			values[k + 1] = m._row_values[k];
 		}
-		else if (std::holds_alternative<expressions::term>(e))
+	}
+	glp_load_matrix(_lp, nonzeros, row_indices.data(), column_indices.data(), values.data());
+}
+
+// New rows enter the basis with their auxiliary variable, so the basis of
+// the last solve stays valid
+bool glpk::append_rows(const matrix& m, size_t first_row, size_t loaded_rows)
+{
+	if (!_lp || glp_get_num_rows(_lp) != (int)loaded_rows || glp_get_num_cols(_lp) != (int)m._columns)
+		return false;
+	int rows = (int)(m.row_count() - first_row);
+	if (rows == 0)
+		return true;
+	int first = glp_add_rows(_lp, rows);
+	std::vector<int> indices(1);
+	std::vector<double> values(1);
+	for (int i = 0; i < rows; ++i)
+	{
+		size_t row = first_row + i;
+		set_row_bounds(_lp, first + i, m._row_lower[row], m._row_upper[row]);
+		indices.resize(1);
+		values.resize(1);
+		for (int k = m._row_starts[row]; k < m._row_starts[row + 1]; ++k)
 		{
-			const auto&term = std::get<expressions::term>(e);
-			std::vector<int> indices(2);
-			std::vector<double> values(2);
-			indices[1] = (int)term._variable.absolute_index() + 1;
-			values[1] = term._coefficient._value;
-			glp_set_row_bnds(_lp, current_row, type, c._lower_bound.value(), c._upper_bound.value());
-			glp_set_mat_row(_lp, current_row, 1, &indices[0], &values[0]);
+			indices.push_back(m._row_indices[k] + 1);
+			values.push_back(m._row_values[k]);
 		}
-		else if (std::holds_alternative<expressions::variable>(e))
+		glp_set_mat_row(_lp, first + i, (int)indices.size() - 1, indices.data(), values.data());
+	}
+	return true;
+}
+
+bool glpk::set_objective(const matrix& m)
+{
+	if (!_lp || glp_get_num_cols(_lp) != (int)m._columns)
+		return false;
+	for (int j = 0; j < (int)m._columns; ++j)
+		glp_set_obj_coef(_lp, j + 1, m._cost[j]);
+	glp_set_obj_coef(_lp, 0, m._offset);
+	glp_set_obj_dir(_lp, m._minimize ? GLP_MIN : GLP_MAX);
+	return true;
+}
+
+bool glpk::change_column_bounds(const matrix& m, const std::vector<int>& columns)
+{
+	if (!_lp || glp_get_num_cols(_lp) != (int)m._columns)
+		return false;
+	for (int j : columns)
+		set_column_bounds(_lp, j + 1, m._column_lower[j], m._column_upper[j]);
+	return true;
+}
+
+bool glpk::change_column_types(const matrix& m, const std::vector<int>& columns)
+{
+	if (!_lp || glp_get_num_cols(_lp) != (int)m._columns)
+		return false;
+	for (int j : columns)
+		glp_set_col_kind(_lp, j + 1, m.has_integers() && m._integer[j] ? GLP_IV : GLP_CV);
+	_mip = m.has_integers();
+	return true;
+}
+
+void glpk::read_values()
+{
+	int columns = glp_get_num_cols(_lp);
+	_solution._values.resize(columns);
+	for (int j = 1; j <= columns; ++j)
+	{
+		switch (_kind)
 		{
-			const auto&var = std::get<expressions::variable>(e);
-			std::vector<int> indices(2);
-			std::vector<double> values(2);
-			indices[1] = (int)var.absolute_index() + 1;
-			values[1] = 1;
-			glp_set_row_bnds(_lp, current_row, type, c._lower_bound.value(), c._upper_bound.value());
-			glp_set_mat_row(_lp, current_row, 1, &indices[0], &values[0]);
+		case solution::mip: _solution._values[j - 1] = glp_mip_col_val(_lp, j); break;
+		case solution::interior: _solution._values[j - 1] = glp_ipt_col_prim(_lp, j); break;
+		default: _solution._values[j - 1] = glp_get_col_prim(_lp, j); break;
 		}
-		else
+	}
+}
+
+// The final basis of the relaxation, for a MIP too
+void glpk::get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns)
+{
+	if (!_lp || _kind == solution::interior)
+		return;
+	auto status = [](int s) {
+		switch (s)
 		{
+		case GLP_BS: return basis_status::basic;
+		case GLP_NL: return basis_status::lower;
+		case GLP_NU: return basis_status::upper;
+		case GLP_NF: return basis_status::free;
+		default: return basis_status::fixed;
+		}
+	};
+	rows.resize(glp_get_num_rows(_lp));
+	for (int i = 1; i <= (int)rows.size(); ++i)
+		rows[i - 1] = status(glp_get_row_stat(_lp, i));
+	columns.resize(glp_get_num_cols(_lp));
+	for (int j = 1; j <= (int)columns.size(); ++j)
+		columns[j - 1] = status(glp_get_col_stat(_lp, j));
+}
 
+// glp_simplex starts from the basis when glp_warm_up can factorize it, a
+// singular one is replaced by the standard basis
+void glpk::set_basis(const std::vector<basis_status>& rows, const std::vector<basis_status>& columns)
+{
+	auto status = [](basis_status s) {
+		switch (s)
+		{
+		case basis_status::basic: return GLP_BS;
+		case basis_status::lower: return GLP_NL;
+		case basis_status::upper: return GLP_NU;
+		case basis_status::free: return GLP_NF;
+		default: return GLP_NS;
 		}
-	}
+	};
+	for (int i = 1; i <= (int)rows.size(); ++i)
+		glp_set_row_stat(_lp, i, status(rows[i - 1]));
+	for (int j = 1; j <= (int)columns.size(); ++j)
+		glp_set_col_stat(_lp, j, status(columns[j - 1]));
+	if (glp_warm_up(_lp) != 0)
+		glp_std_basis(_lp);
+}
 
-	if(_model->_minimize)
-		glp_set_obj_dir(_lp, GLP_MIN);
-	else
-		glp_set_obj_dir(_lp, GLP_MAX);
+void glpk::get_duals(std::vector<double>& rows)
+{
+	if (!_lp || _mip || _kind != solution::basic)
+		return;
+	rows.resize(glp_get_num_rows(_lp));
+	for (int i = 1; i <= (int)rows.size(); ++i)
+		rows[i - 1] = glp_get_row_dual(_lp, i);
+}
 
-	const auto& objective = _model->_objective;
-	if (std::holds_alternative<expressions::sum>(objective))
+void glpk::run()
+{
+	_kind = solution::basic;
+	if (_control.cancelled())
 	{
-		const auto&sum = std::get<expressions::sum>(objective);
-		glp_set_obj_coef(_lp, 0, sum._constant_term._value);
-		for (const auto&term : sum._terms)
+		_result._status = solve_status::cancelled;
+		return;
+	}
+	if (_options._algorithm == lp_algorithm::interior && !_mip)
+	{
+		glp_iptcp parm;
+		glp_init_iptcp(&parm);
+		parm.msg_lev = message_level(_options, parm.msg_lev);
+		_result._backend_code = glp_interior(_lp, &parm);
+		_result._status = interior_status(_result._backend_code, _lp);
+		_kind = solution::interior;
+		if (_result._status == solve_status::optimal)
 		{
-			glp_set_obj_coef(_lp, (int)term.first + 1, term.second._coefficient._value);
+			_result._objective = glp_ipt_obj_val(_lp);
+			read_values();
 		}
+		return;
 	}
 
 	glp_smcp parm;
 	glp_init_smcp(&parm);
-	glp_simplex(_lp, &parm);
-}
+	set_parameters(parm, _options);
 
-double glpk::get_objective_value()
-{
-	return glp_get_obj_val(_lp);
+	callback_info callback{ &_control, _options._verbose.value_or(true), false, 0, nullptr, false };
+	_control.start();
+	if (_control.active())
+	{
+		// the terminal hook only sees the log lines glpk prints
+		parm.msg_lev = std::max(parm.msg_lev, GLP_MSG_ON);
+		glp_term_hook(terminal_hook, &callback);
+		_result._backend_code = _control._interrupt ? sliced_simplex(_lp, parm, _control) : glp_simplex(_lp, &parm);
+		glp_term_hook(nullptr, nullptr);
+	}
+	else
+		_result._backend_code = glp_simplex(_lp, &parm);
+	_result._status = simplex_status(_result._backend_code, _lp);
+	if (_result._status == solve_status::optimal && _options._exact)
+	{
+		_result._backend_code = glp_exact(_lp, &parm);
+		_result._status = simplex_status(_result._backend_code, _lp);
+	}
+	_result._iterations = (size_t)glp_get_it_cnt(_lp);
+
+	// The relaxation's solution is no solution of a MIP
+	if (!_mip && (_result._status == solve_status::optimal || _result._status == solve_status::feasible))
+	{
+		_result._objective = glp_get_obj_val(_lp);
+		read_values();
+	}
+	if (!_mip || _result._status != solve_status::optimal)
+		return;
+	if (_control.cancelled())
+	{
+		_result._status = solve_status::cancelled;
+		return;
+	}
+
+	glp_iocp iocp;
+	glp_init_iocp(&iocp);
+	set_parameters(iocp, _options);
+	std::vector<double> start;
+	if (!_start_columns.empty())
+	{
+		start.push_back(0);
+		start.insert(start.end(), _start_columns.begin(), _start_columns.end());
+		callback._start = start.data();
+	}
+	iocp.cb_func = branch_hook;
+	iocp.cb_info = &callback;
+	_result._backend_code = glp_intopt(_lp, &iocp);
+	_result._status = mip_status(_result._backend_code, _lp);
+	_result._iterations = (size_t)glp_get_it_cnt(_lp);
+	_result._nodes = callback._nodes;
+	if (!_start_columns.empty())
+		_result._start_accepted = callback._start_accepted;
+	_kind = solution::mip;
+	if (glp_mip_status(_lp) == GLP_OPT || glp_mip_status(_lp) == GLP_FEAS)
+	{
+		_result._objective = glp_mip_obj_val(_lp);
+		read_values();
+	}
 }
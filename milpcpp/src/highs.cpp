@@ -0,0 +1,331 @@
+#include<milpcpp/highs.h>
+#include<milpcpp/milpcpp.h>
+
+#include <interfaces/highs_c_api.h>
+
+#include"solver_support.h"
+
+#include<algorithm>
+#include<cmath>
+#include<vector>
+
+using namespace milpcpp;
+using namespace milpcpp::solver_support;
+
+static_assert(sizeof(HighsInt) == sizeof(int), "HiGHS must be built with 32 bit HighsInt");
+
+namespace
+{
+	solve_status status(HighsInt model_status, bool has_solution)
+	{
+		switch (model_status)
+		{
+		case kHighsModelStatusOptimal:
+		case kHighsModelStatusModelEmpty: return solve_status::optimal;
+		case kHighsModelStatusInfeasible: return solve_status::infeasible;
+		case kHighsModelStatusUnboundedOrInfeasible: return solve_status::infeasible_or_unbounded;
+		case kHighsModelStatusUnbounded: return solve_status::unbounded;
+		case kHighsModelStatusTimeLimit: return solve_status::time_limit;
+		case kHighsModelStatusIterationLimit: return solve_status::iteration_limit;
+		case kHighsModelStatusInterrupt: return solve_status::cancelled;
+		case kHighsModelStatusObjectiveBound:
+		case kHighsModelStatusObjectiveTarget:
+		case kHighsModelStatusSolutionLimit: return has_solution ? solve_status::feasible : solve_status::failed;
+		default: return solve_status::failed;
+		}
+	}
+
+	// HiGHS has no status for a fixed column, it is at its lower bound
+	const basis_codes highs_basis = { kHighsBasisStatusBasic, kHighsBasisStatusLower, kHighsBasisStatusUpper, kHighsBasisStatusZero, kHighsBasisStatusLower };
+
+	// Called by the simplex, the IPM and the branch and bound of the
+	// solving thread; setting user_interrupt stops them.
+	void callback(int type, const char * message, const HighsCallbackDataOut * out, HighsCallbackDataIn * in, void * info)
+	{
+		auto control = (solve_control*)info;
+		if (type == kHighsCallbackMipImprovingSolution || control->report_due())
+		{
+			progress p;
+			if (type == kHighsCallbackIpmInterrupt)
+			{
+				p._iterations = (size_t)out->ipm_iteration_count;
+			}
+			else if (type == kHighsCallbackSimplexInterrupt)
+			{
+				p._iterations = (size_t)out->simplex_iteration_count;
+				p._objective = out->objective_function_value;
+			}
+			else
+			{
+				p._iterations = (size_t)out->mip_total_lp_iterations;
+				p._nodes = (size_t)out->mip_node_count;
+				if (std::isfinite(out->mip_primal_bound))	// infinite before the first incumbent
+				{
+					p._objective = out->mip_primal_bound;
+					p._mip_gap = out->mip_gap;
+				}
+				p._bound = out->mip_dual_bound;
+			}
+			control->report(p);
+		}
+		if (in && control->cancelled())
+			in->user_interrupt = 1;
+	}
+}
+
+highs::highs(model * m, const options& o) :backend(m), _highs(nullptr), _mip(false), _options(o)
+{
+}
+
+highs::~highs()
+{
+	if (_highs)
+		Highs_destroy(_highs);
+}
+
+void highs::load(const matrix& m)
+{
+	if (_highs)
+		Highs_destroy(_highs);
+	_highs = Highs_create();
+
+	int columns = (int)m._columns;
+	int rows = (int)m.row_count();
+	int nonzeros = (int)m.nonzero_count();
+
+	std::vector<int> column_starts, column_indices;
+	std::vector<double> column_values;
+	m.to_columns(column_starts, column_indices, column_values);
+
+	// HiGHS' infinity is configurable, map the infinite bounds to it
+	double infinity = Highs_getInfinity(_highs);
+	std::vector<double> lower = solver_bounds(m._column_lower, 0, infinity), upper = solver_bounds(m._column_upper, 0, infinity);
+	std::vector<double> row_lower = solver_bounds(m._row_lower, 0, infinity), row_upper = solver_bounds(m._row_upper, 0, infinity);
+
+	_mip = m.is_mip();
+	std::vector<int> integrality;
+	if (_mip)
+	{
+		integrality.resize(columns);
+		for (int j = 0; j < columns; ++j)
+		{
+			bool integer = m.has_integers() && m._integer[j];
+			if (m.has_semicontinuous() && m._semicontinuous[j])
+				integrality[j] = integer ? kHighsVarTypeSemiInteger : kHighsVarTypeSemiContinuous;
+			else
+				integrality[j] = integer ? kHighsVarTypeInteger : kHighsVarTypeContinuous;
+		}
+	}
+
+	HighsInt sense = m._minimize ? kHighsObjSenseMinimize : kHighsObjSenseMaximize;
+	HighsInt code = _mip ?
+		Highs_passMip(_highs, columns, rows, nonzeros, kHighsMatrixFormatColwise, sense, m._offset,
+			m._cost.data(), lower.data(), upper.data(), row_lower.data(), row_upper.data(),
+			column_starts.data(), column_indices.data(), column_values.data(), integrality.data()) :
+		Highs_passLp(_highs, columns, rows, nonzeros, kHighsMatrixFormatColwise, sense, m._offset,
+			m._cost.data(), lower.data(), upper.data(), row_lower.data(), row_upper.data(),
+			column_starts.data(), column_indices.data(), column_values.data());
+	if (code == kHighsStatusError)
+		throw std::runtime_error("HiGHS rejected the model");
+
+	for (size_t j = 0; j < m._names.size(); ++j)
+		Highs_passColName(_highs, (HighsInt)j, m._names[j].c_str());
+}
+
+void highs::apply_options()
+{
+	if (_options._verbose.has_value())
+		Highs_setBoolOptionValue(_highs, "output_flag", _options._verbose.value());
+	Highs_setStringOptionValue(_highs, "solver", _options._algorithm == lp_algorithm::interior ? "ipm" : "simplex");
+	if (_options._presolve.has_value())
+		Highs_setStringOptionValue(_highs, "presolve", _options._presolve.value() ? "on" : "off");
+	if (_options._parallel)
+		Highs_setStringOptionValue(_highs, "parallel", "on");
+	if (_options._threads.has_value())
+		Highs_setIntOptionValue(_highs, "threads", _options._threads.value());
+	if (_options._crossover.has_value())
+		Highs_setStringOptionValue(_highs, "run_crossover", _options._crossover.value() ? "on" : "off");
+
+	switch (_options._method)
+	{
+	case simplex_method::primal: Highs_setIntOptionValue(_highs, "simplex_strategy", kHighsSimplexStrategyPrimal); break;
+	case simplex_method::dual:
+	case simplex_method::dual_then_primal:
+		Highs_setIntOptionValue(_highs, "simplex_strategy", _options._parallel ? kHighsSimplexStrategyDualMulti : kHighsSimplexStrategyDual);
+		break;
+	default:
+		if (_options._parallel)
+			Highs_setIntOptionValue(_highs, "simplex_strategy", kHighsSimplexStrategyDualMulti);
+		break;
+	}
+
+	int weights = -1;
+	switch (_options._pricing)
+	{
+	case pricing_rule::dantzig: weights = 0; break;
+	case pricing_rule::devex: weights = 1; break;
+	case pricing_rule::steepest_edge: weights = 2; break;
+	default: break;
+	}
+	if (weights >= 0)
+	{
+		Highs_setIntOptionValue(_highs, "simplex_dual_edge_weight_strategy", weights);
+		Highs_setIntOptionValue(_highs, "simplex_primal_edge_weight_strategy", weights);
+	}
+
+	if (_options._iteration_limit.has_value())
+	{
+		Highs_setIntOptionValue(_highs, "simplex_iteration_limit", _options._iteration_limit.value());
+		Highs_setIntOptionValue(_highs, "ipm_iteration_limit", _options._iteration_limit.value());
+	}
+	if (_options._time_limit.has_value())
+		Highs_setDoubleOptionValue(_highs, "time_limit", _options._time_limit.value());
+	if (_options._mip_gap.has_value())
+		Highs_setDoubleOptionValue(_highs, "mip_rel_gap", _options._mip_gap.value());
+}
+
+void highs::run()
+{
+	if (_control.cancelled())
+	{
+		_result._status = solve_status::cancelled;
+		return;
+	}
+	apply_options();
+
+	_control.start();
+	if (_control.active())
+	{
+		Highs_setCallback(_highs, callback, &_control);
+		Highs_startCallback(_highs, kHighsCallbackSimplexInterrupt);
+		Highs_startCallback(_highs, kHighsCallbackIpmInterrupt);
+		if (_mip)
+		{
+			Highs_startCallback(_highs, kHighsCallbackMipInterrupt);
+			Highs_startCallback(_highs, kHighsCallbackMipImprovingSolution);
+		}
+	}
+	// HiGHS checks the start when it runs and keeps it as the first
+	// incumbent, setSolution() only stores it
+	bool start = _mip && !_start_columns.empty() &&
+		Highs_setSolution(_highs, _start_columns.data(), nullptr, nullptr, nullptr) != kHighsStatusError;
+	_result._backend_code = Highs_run(_highs);
+
+	HighsInt primal_status = kHighsSolutionStatusNone;
+	Highs_getIntInfoValue(_highs, "primal_solution_status", &primal_status);
+	bool has_solution = primal_status == kHighsSolutionStatusFeasible;
+	_result._status = _result._backend_code == kHighsStatusError ?
+		solve_status::failed : status(Highs_getModelStatus(_highs), has_solution);
+
+	HighsInt simplex = 0, ipm = 0, crossover = 0;
+	Highs_getIntInfoValue(_highs, "simplex_iteration_count", &simplex);
+	Highs_getIntInfoValue(_highs, "ipm_iteration_count", &ipm);
+	Highs_getIntInfoValue(_highs, "crossover_iteration_count", &crossover);
+	_result._iterations = (size_t)(std::max(simplex, 0) + std::max(ipm, 0) + std::max(crossover, 0));
+	if (_mip)
+	{
+		int64_t nodes = 0;
+		Highs_getInt64InfoValue(_highs, "mip_node_count", &nodes);
+		_result._nodes = (size_t)std::max<int64_t>(nodes, 0);
+	}
+
+	if (has_solution)
+	{
+		_result._objective = Highs_getObjectiveValue(_highs);
+		_solution._values.resize((size_t)Highs_getNumCol(_highs));
+		Highs_getSolution(_highs, _solution._values.data(), nullptr, nullptr, nullptr);
+	}
+	if (_mip && !_start_columns.empty())
+		_result._start_accepted = start && kept_start();
+}
+
+void highs::get_basis(std::vector<basis_status>& rows, std::vector<basis_status>& columns)
+{
+	HighsInt validity = 0;
+	Highs_getIntInfoValue(_highs, "basis_validity", &validity);
+	if (_mip || validity != kHighsBasisValidityValid)
+		return;
+	std::vector<HighsInt> column_status((size_t)Highs_getNumCol(_highs)), row_status((size_t)Highs_getNumRow(_highs));
+	Highs_getBasis(_highs, column_status.data(), row_status.data());
+	columns = from_solver_basis(column_status, highs_basis, basis_status::fixed);
+	rows = from_solver_basis(row_status, highs_basis, basis_status::fixed);
+}
+
+// HiGHS keeps the basis and solution of the last solve for the next one
+bool highs::append_rows(const matrix& m, size_t first_row, size_t loaded_rows)
+{
+	if (!_highs || Highs_getNumRow(_highs) != (HighsInt)loaded_rows || Highs_getNumCol(_highs) != (HighsInt)m._columns)
+		return false;
+	HighsInt rows = (HighsInt)(m.row_count() - first_row);
+	if (rows == 0)
+		return true;
+	double infinity = Highs_getInfinity(_highs);
+	std::vector<double> lower = solver_bounds(m._row_lower, first_row, infinity), upper = solver_bounds(m._row_upper, first_row, infinity);
+	int offset = m._row_starts[first_row];
+	std::vector<HighsInt> starts(m._row_starts.begin() + first_row, m._row_starts.end() - 1);
+	for (HighsInt& s : starts)
+		s -= offset;
+	std::vector<HighsInt> indices(m._row_indices.begin() + offset, m._row_indices.end());
+	return Highs_addRows(_highs, rows, lower.data(), upper.data(), (HighsInt)indices.size(),
+		starts.data(), indices.data(), m._row_values.data() + offset) != kHighsStatusError;
+}
+
+bool highs::set_objective(const matrix& m)
+{
+	if (!_highs || Highs_getNumCol(_highs) != (HighsInt)m._columns)
+		return false;
+	if (m._columns > 0 && Highs_changeColsCostByRange(_highs, 0, (HighsInt)m._columns - 1, m._cost.data()) == kHighsStatusError)
+		return false;
+	HighsInt sense = m._minimize ? kHighsObjSenseMinimize : kHighsObjSenseMaximize;
+	return Highs_changeObjectiveOffset(_highs, m._offset) != kHighsStatusError &&
+		Highs_changeObjectiveSense(_highs, sense) != kHighsStatusError;
+}
+
+bool highs::change_column_bounds(const matrix& m, const std::vector<int>& columns)
+{
+	if (!_highs || Highs_getNumCol(_highs) != (HighsInt)m._columns)
+		return false;
+	if (columns.empty())
+		return true;
+	double infinity = Highs_getInfinity(_highs);
+	std::vector<HighsInt> set(columns.begin(), columns.end());
+	std::vector<double> lower, upper;
+	for (int j : columns)
+	{
+		lower.push_back(m._column_lower[j] == -matrix::infinity ? -infinity : m._column_lower[j]);
+		upper.push_back(m._column_upper[j] == matrix::infinity ? infinity : m._column_upper[j]);
+	}
+	return Highs_changeColsBoundsBySet(_highs, (HighsInt)set.size(), set.data(), lower.data(), upper.data()) != kHighsStatusError;
+}
+
+// Semi-continuous columns keep the kind they were loaded with
+bool highs::change_column_types(const matrix& m, const std::vector<int>& columns)
+{
+	if (!_highs || Highs_getNumCol(_highs) != (HighsInt)m._columns || m.has_semicontinuous())
+		return false;
+	std::vector<HighsInt> set(columns.begin(), columns.end()), integrality;
+	for (int j : columns)
+		integrality.push_back(m.has_integers() && m._integer[j] ? kHighsVarTypeInteger : kHighsVarTypeContinuous);
+	if (Highs_changeColsIntegralityBySet(_highs, (HighsInt)set.size(), set.data(), integrality.data()) == kHighsStatusError)
+		return false;
+	_mip = m.is_mip();
+	return true;
+}
+
+void highs::get_duals(std::vector<double>& rows)
+{
+	if (!_highs || _mip)
+		return;
+	rows.resize((size_t)Highs_getNumRow(_highs));
+	Highs_getSolution(_highs, nullptr, nullptr, nullptr, rows.data());
+}
+
+// HiGHS rejects a basis it finds inconsistent and starts its simplex from
+// a valid one
+void highs::set_basis(const std::vector<basis_status>& rows, const std::vector<basis_status>& columns)
+{
+	if (_mip)
+		return;
+	std::vector<HighsInt> column_status = to_solver_basis(columns, highs_basis), row_status = to_solver_basis(rows, highs_basis);
+	Highs_setBasis(_highs, column_status.data(), row_status.data());
+}
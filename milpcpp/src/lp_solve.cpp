@@ -1,148 +1,229 @@
 #include<milpcpp/lp_solve.h>
 #include<milpcpp/milpcpp.h>
 
-#include <milpcpp/enumerate.h>
-
 #include <lp_lib.h>
 
-#include<variant>
+#include<cmath>
+#include<string>
+#include<vector>
 
 using namespace milpcpp;
 
-lp_solve::lp_solve(model * m) :_model(m)
+namespace
+{
+	solve_status status(int code)
+	{
+		switch (code)
+		{
+		case OPTIMAL:
+		case PRESOLVED: return solve_status::optimal;
+		case SUBOPTIMAL:						// a MIP stopped early with an incumbent
+		case PROCBREAK:
+		case FEASFOUND: return solve_status::feasible;
+		case INFEASIBLE:
+		case NOFEASFOUND: return solve_status::infeasible;
+		case UNBOUNDED: return solve_status::unbounded;
+		case TIMEOUT: return solve_status::time_limit;
+		case USERABORT: return solve_status::cancelled;
+		default: return solve_status::failed;
+		}
+	}
+
+	progress current_progress(lprec * lp)
+	{
+		progress p;
+		p._iterations = (size_t)get_total_iter(lp);
+		p._nodes = (size_t)get_total_nodes(lp);
+		p._objective = get_working_objective(lp);
+		return p;
+	}
+
+	// Polled by lp_solve during the simplex and the branch and bound
+	int __WINAPI abort_hook(lprec * lp, void * info)
+	{
+		auto control = (solve_control*)info;
+		if (control->report_due())
+			control->report(current_progress(lp));
+		return control->cancelled() ? TRUE : FALSE;
+	}
+
+	void __WINAPI message_hook(lprec * lp, void * info, int message)
+	{
+		((solve_control*)info)->report(current_progress(lp));
+	}
+}
+
+lp_solve::lp_solve(model * m, const options& o) :backend(m), _lp(nullptr), _options(o)
 {
 }
 
 lp_solve::~lp_solve()
 {
-	delete_lp(_lp);
+	if (_lp)
+		delete_lp(_lp);
 }
 
-void lp_solve::solve()
+void lp_solve::load(const matrix& m)
 {
-	int var_count = (int)_model->variable_count();
-	_lp = make_lp(0, var_count);
+	if (_lp)
+		delete_lp(_lp);
+	int columns = (int)m._columns;
+	_lp = make_lp(0, columns);
 
 	set_add_rowmode(_lp, TRUE);
 
-	for (int i = 1; i <= var_count; ++i)
+	double infinity = get_infinite(_lp);
+	for (int j = 0; j < columns; ++j)
 	{
-		set_col_name(_lp, i, const_cast<char*>(_model->variable_name(i - 1).c_str()));
-		if (_model->has_lower_bound(i - 1) && _model->has_upper_bound(i - 1))
-		{
-			set_bounds(_lp, i, 
-				_model->get_lower_bound(i - 1),
-				_model->get_upper_bound(i - 1));
-		}
-		else if (_model->has_lower_bound(i - 1))
-		{
-			set_bounds(_lp, i, 
-				_model->get_lower_bound(i - 1),
-				get_infinite(_lp));
-		}
-		else if (_model->has_upper_bound(i - 1))
-		{
-			set_bounds(_lp, i, 
-				-get_infinite(_lp),
-				_model->get_upper_bound(i - 1));
-		}
+		double lower = m._column_lower[j], upper = m._column_upper[j];
+		if (lower == -matrix::infinity && upper == matrix::infinity)
+			set_unbounded(_lp, j + 1);
 		else
-		{
-			set_unbounded(_lp, i);
-		}
+			set_bounds(_lp, j + 1,
+				lower == -matrix::infinity ? -infinity : lower,
+				upper == matrix::infinity ? infinity : upper);
+		if (m.has_integers() && m._integer[j])
+			set_int(_lp, j + 1, TRUE);
+		if (m.has_semicontinuous() && m._semicontinuous[j])
+			set_semicont(_lp, j + 1, TRUE);
+		if (!m._names.empty())
+			set_col_name(_lp, j + 1, const_cast<char*>(m._names[j].c_str()));
 	}
 
-	for (const auto & c : _model->_constraints)
+	// add_constraintex takes 1 based columns
+	std::vector<int> indices;
+	for (size_t i = 0; i < m.row_count(); ++i)
 	{
-		const auto & e = c._expression;
-
-		if (std::holds_alternative<expressions::sum>(e))
-		{
-			const auto&sum = std::get<expressions::sum>(e);
-			double lower = c._lower_bound.value_or(0) - sum._constant_term._value;
-			double upper = c._upper_bound.value_or(0) - sum._constant_term._value;
-			int size = (int)sum._terms.size();
-			std::vector<int> indices(size);
-			std::vector<double> values(size);
-			int current_index = 0;
-			for (const auto&i : sum._terms)
-			{
-				indices[current_index] = ((int)(i.first + 1));
-				values[current_index] = (i.second._coefficient._value);
-				++current_index;
-			}
-			if(c._lower_bound.has_value())
-				add_constraintex(_lp, size, &values[0], &indices[0], GE, lower);
-			if(c._upper_bound.has_value())
-				add_constraintex(_lp, size, &values[0], &indices[0], LE, upper);
-
-		}
-		else if (std::holds_alternative<expressions::term>(e))
+		int start = m._row_starts[i], size = m._row_starts[i + 1] - start;
+		indices.resize(size);
+		for (int k = 0; k < size; ++k)
+			indices[k] = m._row_indices[start + k] + 1;
+		double * values = const_cast<double*>(m._row_values.data() + start);
+		double lower = m._row_lower[i], upper = m._row_upper[i];
+		if (lower == upper)
 		{
-			const auto&term = std::get<expressions::term>(e);
-			int index = (int)term._variable.absolute_index() + 1;
-			double value = term._coefficient._value;
-			if (c._lower_bound.has_value())
-				add_constraintex(_lp, 1, &value, &index, GE, c._lower_bound.value());
-			if (c._upper_bound.has_value())
-				add_constraintex(_lp, 1, &value, &index, LE, c._upper_bound.value());
-		}
-		else if (std::holds_alternative<expressions::variable>(e))
-		{
-			const auto&var = std::get<expressions::variable>(e);
-			int index = (int)var.absolute_index() + 1;
-			double value = 1;
-			if (c._lower_bound.has_value())
-				add_constraintex(_lp, 1, &value, &index, GE, c._lower_bound.value());
-			if (c._upper_bound.has_value())
-				add_constraintex(_lp, 1, &value, &index, LE, c._upper_bound.value());
-		}
-		else
-		{
-
+			add_constraintex(_lp, size, values, indices.data(), EQ, lower);
+			continue;
 		}
+		if (lower != -matrix::infinity)
+			add_constraintex(_lp, size, values, indices.data(), GE, lower);
+		if (upper != matrix::infinity)
+			add_constraintex(_lp, size, values, indices.data(), LE, upper);
 	}
 
 	set_add_rowmode(_lp, FALSE);
 
-	const auto& objective = _model->_objective;
-	if (std::holds_alternative<expressions::sum>(objective))
+	// Branched on in the order they were declared
+	for (size_t k = 0; k < m.sos_count(); ++k)
 	{
-		const auto&sum = std::get<expressions::sum>(objective);
-		int size = (int)sum._terms.size();
-		std::vector<int> indices(size);
-		std::vector<double> values(size);
-
-		auto terms =  // range/iterator of (variable index, coeffient) pairs
-			sum._terms |
-			ranges::view::transform([](auto e) {
-				return std::make_pair(e.first, e.second._coefficient._value);
-		});
-
-		for (const auto&[current_index, term] : utils::enumerate(terms))
-		{
-			const auto&[index, value] = term;
-			indices[current_index] = (int)index + 1;
-			values[current_index] = value;
-		}
-		set_obj_fnex(_lp, size, &values[0], &indices[0]);
+		int start = m._sos_starts[k], size = m._sos_starts[k + 1] - start;
+		indices.resize(size);
+		for (int t = 0; t < size; ++t)
+			indices[t] = m._sos_columns[start + t] + 1;
+		std::string name = "SOS" + std::to_string(k + 1);
+		add_SOS(_lp, const_cast<char*>(name.c_str()), (int)m._sos_types[k], (int)k + 1, size, indices.data(),
+			const_cast<double*>(m._sos_weights.data() + start));
+	}
+
+	std::vector<double> values;
+	indices.clear();
+	for (int j = 0; j < columns; ++j)
+	{
+		if (m._cost[j] == 0)
+			continue;
+		indices.push_back(j + 1);
+		values.push_back(m._cost[j]);
 	}
+	set_obj_fnex(_lp, (int)values.size(), values.data(), indices.data());
+	if (m._offset != 0)
+		set_rh(_lp, 0, m._offset);
 
-	if (_model->_minimize)
+	if (m._minimize)
 		set_minim(_lp);
 	else
 		set_maxim(_lp);
 
 	set_verbose(_lp, CRITICAL);
+}
 
-	if (!::solve(_lp))
+void lp_solve::apply_options()
+{
+	switch (_options._method)
 	{
-		get_ptr_variables(_lp, &_variable_values);
+	case simplex_method::primal: set_simplextype(_lp, SIMPLEX_PRIMAL_PRIMAL); break;
+	case simplex_method::dual: set_simplextype(_lp, SIMPLEX_DUAL_DUAL); break;
+	case simplex_method::dual_then_primal: set_simplextype(_lp, SIMPLEX_DUAL_PRIMAL); break;
+	default: break;
+	}
+	switch (_options._pricing)
+	{
+	case pricing_rule::dantzig: set_pivoting(_lp, PRICER_DANTZIG + PRICE_ADAPTIVE); break;
+	case pricing_rule::devex: set_pivoting(_lp, PRICER_DEVEX + PRICE_ADAPTIVE); break;
+	case pricing_rule::steepest_edge: set_pivoting(_lp, PRICER_STEEPESTEDGE + PRICE_ADAPTIVE); break;
+	default: break;
+	}
+	if (_options._presolve.value_or(false))
+		set_presolve(_lp, PRESOLVE_ROWS | PRESOLVE_COLS | PRESOLVE_LINDEP, get_presolveloops(_lp));
+	if (_options._verbose.has_value())
+		set_verbose(_lp, _options._verbose.value() ? NORMAL : CRITICAL);
+	if (_options._time_limit.has_value())
+		set_timeout(_lp, (long)std::ceil(_options._time_limit.value()));
+	if (_options._mip_gap.has_value())
+		set_mip_gap(_lp, FALSE, _options._mip_gap.value());
+	if (_options._scaling.has_value())
+		set_scaling(_lp, _options._scaling.value());
+	if (_options._epsilon_level.has_value())
+		set_epslevel(_lp, _options._epsilon_level.value());
+	if (_options._depth_limit.has_value())
+		set_bb_depthlimit(_lp, _options._depth_limit.value());
+
+	_control.start();
+	if (_control.active())
+	{
+		put_abortfunc(_lp, abort_hook, &_control);
+		put_msgfunc(_lp, message_hook, &_control, MSG_LPFEASIBLE | MSG_LPOPTIMAL | MSG_MILPFEASIBLE | MSG_MILPBETTER);
 	}
-
 }
 
-double lp_solve::get_objective_value()
+void lp_solve::run()
 {
-	return get_objective(_lp);
+	apply_options();
+	if (_control.cancelled())
+	{
+		_result._status = solve_status::cancelled;
+		return;
+	}
+
+	// lp_solve takes no incumbent: the start's objective bounds the branch
+	// and bound, and a basis guessed from it starts the root LP
+	bool start = !_start_columns.empty();
+	if (start)
+	{
+		std::vector<double> guess(1);
+		guess.insert(guess.end(), _start_columns.begin(), _start_columns.end());
+		std::vector<int> basis(1 + get_Nrows(_lp) + get_Ncolumns(_lp));
+		if (guess_basis(_lp, guess.data(), basis.data()))
+			::set_basis(_lp, basis.data(), TRUE);
+		set_obj_bound(_lp, _start_objective);
+	}
+
+	_result._backend_code = ::solve(_lp);
+	_result._status = status(_result._backend_code);
+	_result._iterations = (size_t)get_total_iter(_lp);
+	_result._nodes = (size_t)get_total_nodes(_lp);
+	if (_result._status == solve_status::optimal || _result._status == solve_status::feasible)
+	{
+		double * values;
+		get_ptr_variables(_lp, &values);
+		_solution._values.assign(values, values + get_Ncolumns(_lp));
+		_result._objective = get_objective(_lp);
+	}
+	else if (start && _result._status != solve_status::failed)
+	{
+		// Nothing better than the start turned up, the status says why
+		_solution._values = _start_columns;
+		_result._objective = _start_objective;
+	}
+	if (start)
+		_result._start_accepted = kept_start();
 }
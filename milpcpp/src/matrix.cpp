@@ -0,0 +1,292 @@
+#include<milpcpp/model.h>
+
+#include<algorithm>
+#include<cmath>
+#include<stdexcept>
+#include<string>
+#include<variant>
+
+namespace milpcpp
+{
+	void matrix::add_row(const constraint& c)
+	{
+		double constant = 0;
+
+		const auto & e = c._expression;
+
+		if (std::holds_alternative<expressions::sum>(e))
+		{
+			const auto&sum = std::get<expressions::sum>(e);
+			constant = sum._constant_term._value;
+			for (const auto&term : sum._terms)
+			{
+				_row_indices.push_back((int)term._variable.absolute_index());
+				_row_values.push_back(term._coefficient._value);
+			}
+		}
+		else if (std::holds_alternative<expressions::term>(e))
+		{
+			const auto&term = std::get<expressions::term>(e);
+			_row_indices.push_back((int)term._variable.absolute_index());
+			_row_values.push_back(term._coefficient._value);
+		}
+		else if (std::holds_alternative<expressions::variable>(e))
+		{
+			_row_indices.push_back((int)std::get<expressions::variable>(e).absolute_index());
+			_row_values.push_back(1);
+		}
+		else if (std::holds_alternative<expressions::constant>(e))
+		{
+			constant = std::get<expressions::constant>(e)._value;
+		}
+
+		_row_starts.push_back((int)_row_indices.size());
+		_row_lower.push_back(c._lower_bound.has_value() ? c._lower_bound.value() - constant : -infinity);
+		_row_upper.push_back(c._upper_bound.has_value() ? c._upper_bound.value() - constant : infinity);
+	}
+
+	void matrix::clear_rows()
+	{
+		_row_starts.assign(1, 0);
+		_row_indices.clear();
+		_row_values.clear();
+		_row_lower.clear();
+		_row_upper.clear();
+	}
+
+	// A counting sort of the nonzeros by column
+	void matrix::to_columns(std::vector<int>& starts, std::vector<int>& indices, std::vector<double>& values) const
+	{
+		size_t rows = row_count();
+		starts.assign(_columns + 1, 0);
+		for (int index : _row_indices)
+			++starts[index + 1];
+		for (size_t j = 0; j < _columns; ++j)
+			starts[j + 1] += starts[j];
+
+		std::vector<int> next(starts.begin(), starts.end() - 1);
+		indices.resize(nonzero_count());
+		values.resize(nonzero_count());
+		for (size_t i = 0; i < rows; ++i)
+		{
+			for (int k = _row_starts[i]; k < _row_starts[i + 1]; ++k)
+			{
+				int position = next[_row_indices[k]]++;
+				indices[position] = (int)i;
+				values[position] = _row_values[k];
+			}
+		}
+	}
+
+	void matrix::linearize(bool semicontinuous, bool sos, std::vector<double>& start)
+	{
+		semicontinuous = semicontinuous && has_semicontinuous();
+		sos = sos && sos_count() != 0;
+		if (!semicontinuous && !sos)
+			return;
+		if (!has_integers())
+			_integer.resize(_columns);
+
+		auto add_binary = [&](int column, const char * suffix, bool on) {
+			_column_lower.push_back(0);
+			_column_upper.push_back(1);
+			_cost.push_back(0);
+			_integer.push_back(1);
+			if (has_semicontinuous())
+				_semicontinuous.push_back(0);
+			if (!_names.empty())
+				_names.push_back(_names[column] + suffix);
+			if (!start.empty())
+				start.push_back(on ? 1 : 0);
+			return (int)_columns++;
+		};
+		auto add_row = [&](const std::vector<std::pair<int, double>>& terms, double lower, double upper) {
+			for (const auto&[column, value] : terms)
+			{
+				_row_indices.push_back(column);
+				_row_values.push_back(value);
+			}
+			_row_starts.push_back((int)_row_indices.size());
+			_row_lower.push_back(lower);
+			_row_upper.push_back(upper);
+		};
+		// x <= u * sum(z) and x >= l * sum(z), so x is 0 unless a z is 1
+		auto link = [&](int column, const std::vector<int>& binaries) {
+			std::vector<std::pair<int, double>> terms{ { column, 1 } };
+			for (int binary : binaries)
+				terms.emplace_back(binary, -_column_upper[column]);
+			add_row(terms, -infinity, 0);
+			if (_column_lower[column] == 0)
+				return;
+			for (size_t k = 1; k < terms.size(); ++k)
+				terms[k].second = -_column_lower[column];
+			add_row(terms, 0, infinity);
+		};
+		auto nonzero = [&](int column) { return !start.empty() && start[column] != 0; };
+
+		if (semicontinuous)
+		{
+			for (int j = 0, columns = (int)_columns; j < columns; ++j)
+			{
+				if (!_semicontinuous[j])
+					continue;
+				link(j, { add_binary(j, "_on", nonzero(j)) });
+				_column_lower[j] = 0;
+			}
+			_semicontinuous.clear();
+		}
+
+		for (size_t k = 0; sos && k < sos_count(); ++k)
+		{
+			const int * members = &_sos_columns[_sos_starts[k]];
+			int length = _sos_starts[k + 1] - _sos_starts[k];
+			int first_nonzero = length;
+			for (int t = 0; t < length; ++t)
+			{
+				int column = members[t];
+				if (!std::isfinite(_column_lower[column]) || !std::isfinite(_column_upper[column]))
+					throw std::logic_error("Special ordered set member " + (_names.empty() ? std::to_string(column) : _names[column]) + " needs finite bounds");
+				if (first_nonzero == length && nonzero(column))
+					first_nonzero = t;
+			}
+
+			// SOS1: a binary per member. SOS2: a binary per pair of
+			// neighbours, a member is nonzero only with a pair it belongs to.
+			std::vector<int> binaries;
+			if (_sos_types[k] == sos_type::sos1)
+			{
+				for (int t = 0; t < length; ++t)
+				{
+					binaries.push_back(add_binary(members[t], "_sos", t == first_nonzero));
+					link(members[t], { binaries.back() });
+				}
+			}
+			else if (length > 1)
+			{
+				int chosen = first_nonzero < length ? std::min(first_nonzero, length - 2) : -1;
+				for (int t = 0; t + 1 < length; ++t)
+					binaries.push_back(add_binary(members[t], "_sos", t == chosen));
+				link(members[0], { binaries[0] });
+				for (int t = 1; t + 1 < length; ++t)
+					link(members[t], { binaries[t - 1], binaries[t] });
+				link(members[length - 1], { binaries[length - 2] });
+			}
+			if (binaries.empty())
+				continue;
+			std::vector<std::pair<int, double>> terms;
+			for (int binary : binaries)
+				terms.emplace_back(binary, 1);
+			add_row(terms, -infinity, 1);
+		}
+		if (sos)
+		{
+			_sos_types.clear();
+			_sos_starts.assign(1, 0);
+			_sos_columns.clear();
+			_sos_weights.clear();
+		}
+	}
+
+	void model::load_matrix(matrix& m, bool names) const
+	{
+		size_t columns = column_count();
+		m._columns = columns;
+		m._column_lower.resize(columns);
+		m._column_upper.resize(columns);
+		m._integer.clear();
+		if (has_integers())
+			m._integer.resize(columns);
+		m._semicontinuous.clear();
+		if (has_semicontinuous())
+			m._semicontinuous.resize(columns);
+
+		if (_postsolve.active())
+		{
+			for (size_t j = 0; j < columns; ++j)
+			{
+				m._column_lower[j] = has_lower_bound(j) ? get_lower_bound(j) : -matrix::infinity;
+				m._column_upper[j] = has_upper_bound(j) ? get_upper_bound(j) : matrix::infinity;
+				if (m.has_integers())
+					m._integer[j] = is_integer(j);
+			}
+		}
+		else
+		{
+			// Columns are the variables
+			for_each_variable(0, columns, [&](const variable_set& set, size_t j) {
+				m._column_lower[j] = set.has_lower_bound() ? set.get_lower_bound(j) : -matrix::infinity;
+				m._column_upper[j] = set.has_upper_bound() ? set.get_upper_bound(j) : matrix::infinity;
+				if (m.has_integers())
+					m._integer[j] = set.is_integer();
+				if (!set.is_semicontinuous())
+					return;
+				if (!(m._column_lower[j] >= 0) || m._column_upper[j] == matrix::infinity)
+					throw std::logic_error("Semi-continuous variable " + set.name(j) + " needs finite nonnegative bounds");
+				m._semicontinuous[j] = 1;
+			});
+		}
+
+		// Presolve leaves models with SOS sets alone, so columns are variables
+		m._sos_types.clear();
+		m._sos_starts.assign(1, 0);
+		m._sos_columns.clear();
+		m._sos_weights.clear();
+		for (const variable_set * set : _variable_sets)
+		{
+			if (!set->has_sos())
+				continue;
+			size_t stride, length;
+			set->get_sos_layout(stride, length);
+			size_t count = length == 0 ? 0 : set->size() / length;
+			for (size_t k = 0; k < count; ++k)
+			{
+				size_t first = set->start_index() + (k / stride) * stride * length + k % stride;
+				for (size_t t = 0; t < length; ++t)
+				{
+					m._sos_columns.push_back((int)(first + t * stride));
+					m._sos_weights.push_back((double)(t + 1));
+				}
+				m._sos_types.push_back(set->get_sos_type());
+				m._sos_starts.push_back((int)m._sos_columns.size());
+			}
+		}
+
+		m._names.clear();
+		if (names)
+		{
+			m._names.reserve(columns);
+			for (size_t j = 0; j < columns; ++j)
+				m._names.push_back(variable_name(j));
+		}
+
+		m._cost.assign(columns, 0);
+		m._offset = 0;
+		if (std::holds_alternative<expressions::sum>(_objective))
+		{
+			const auto&sum = std::get<expressions::sum>(_objective);
+			m._offset = sum._constant_term._value;
+			for (const auto&term : sum._terms)
+				m._cost[term._variable.absolute_index()] += term._coefficient._value;
+		}
+		else if (std::holds_alternative<expressions::term>(_objective))
+		{
+			const auto&term = std::get<expressions::term>(_objective);
+			m._cost[term._variable.absolute_index()] = term._coefficient._value;
+		}
+		else if (std::holds_alternative<expressions::variable>(_objective))
+		{
+			m._cost[std::get<expressions::variable>(_objective).absolute_index()] = 1;
+		}
+		else if (std::holds_alternative<expressions::constant>(_objective))
+		{
+			m._offset = std::get<expressions::constant>(_objective)._value;
+		}
+		m._minimize = _minimize;
+
+		m._row_starts.reserve(m._row_starts.size() + _constraints.size());
+		m._row_lower.reserve(m._row_lower.size() + _constraints.size());
+		m._row_upper.reserve(m._row_upper.size() + _constraints.size());
+		for (const auto & c : _constraints)
+			m.add_row(c);
+	}
+}
@@ -0,0 +1,411 @@
+#include<milpcpp/milpcpp.h>
+
+#include<algorithm>
+#include<cmath>
+#include<limits>
+#include<map>
+#include<variant>
+
+using namespace milpcpp;
+
+namespace
+{
+	const double infinity = std::numeric_limits<double>::infinity();
+	const double tolerance = 1e-9;
+
+	struct row
+	{
+		std::vector<std::pair<size_t, double>> _terms;	// (absolute index, coefficient), sorted by index
+		double _lower = -infinity;
+		double _upper = infinity;
+		bool _active = true;
+	};
+
+	void collect_terms(const expression& e, std::map<size_t, double>& terms, double& constant)
+	{
+		if (std::holds_alternative<expressions::sum>(e))
+		{
+			const auto&sum = std::get<expressions::sum>(e);
+			for (const auto&term : sum._terms)
+				terms[term._variable.absolute_index()] += term._coefficient._value;
+			constant += sum._constant_term._value;
+		}
+		else if (std::holds_alternative<expressions::term>(e))
+		{
+			const auto&term = std::get<expressions::term>(e);
+			terms[term._variable.absolute_index()] += term._coefficient._value;
+		}
+		else if (std::holds_alternative<expressions::variable>(e))
+		{
+			terms[std::get<expressions::variable>(e).absolute_index()] += 1;
+		}
+		else if (std::holds_alternative<expressions::constant>(e))
+		{
+			constant += std::get<expressions::constant>(e)._value;
+		}
+	}
+
+	row make_row(const constraint& c)
+	{
+		std::map<size_t, double> terms;
+		double constant = 0;
+		collect_terms(c._expression, terms, constant);
+
+		row result;
+		for (const auto&term : terms)
+		{
+			if (term.second != 0)
+				result._terms.push_back(term);
+		}
+		if (c._lower_bound.has_value())
+			result._lower = c._lower_bound.value() - constant;
+		if (c._upper_bound.has_value())
+			result._upper = c._upper_bound.value() - constant;
+		return result;
+	}
+
+	expressions::sum make_sum(const std::vector<std::pair<size_t, double>>& terms, double constant)
+	{
+		expressions::sum result;
+		result._terms.reserve(terms.size());
+		for (const auto&[column, coefficient] : terms)
+		{
+			result._terms.push_back(expressions::term{ { (uint32_t)column }, { coefficient } });
+		}
+		result._constant_term._value = constant;
+		return result;
+	}
+
+	class presolver
+	{
+		const model& _model;
+		std::vector<row>& _rows;
+		std::vector<double> _lower;
+		std::vector<double> _upper;
+		std::vector<bool> _integer;
+		presolve::statistics _statistics;
+
+		static double scaled(double value) { return tolerance * std::max(1.0, std::abs(value)); }
+
+		bool is_fixed(size_t j) const { return _upper[j] - _lower[j] <= scaled(_lower[j]); }
+
+		void check_column(size_t j) const
+		{
+			if (_lower[j] > _upper[j] + scaled(_upper[j]))
+				throw presolve::infeasible_model("Bounds of " + _model.variable_name(j) + " cross");
+		}
+
+		bool tighten_lower(size_t j, double value)
+		{
+			if (_integer[j])
+				value = std::ceil(value - scaled(value));
+			if (value <= _lower[j] + scaled(value))
+				return false;
+			_lower[j] = value;
+			check_column(j);
+			if (is_fixed(j))
+				_upper[j] = _lower[j];
+			++_statistics._bounds_tightened;
+			return true;
+		}
+
+		bool tighten_upper(size_t j, double value)
+		{
+			if (_integer[j])
+				value = std::floor(value + scaled(value));
+			if (value >= _upper[j] - scaled(value))
+				return false;
+			_upper[j] = value;
+			check_column(j);
+			if (is_fixed(j))
+				_lower[j] = _upper[j];
+			++_statistics._bounds_tightened;
+			return true;
+		}
+
+		void remove_row(row& r)
+		{
+			r._active = false;
+			++_statistics._rows_removed;
+		}
+
+		// Substitutes fixed columns, then drops empty rows and turns singleton rows into column bounds
+		bool reduce_row(row& r)
+		{
+			auto fixed = std::remove_if(r._terms.begin(), r._terms.end(), [&](const auto&term) {
+				if (!is_fixed(term.first))
+					return false;
+				r._lower -= term.second * _lower[term.first];
+				r._upper -= term.second * _lower[term.first];
+				return true;
+			});
+			bool changed = fixed != r._terms.end();
+			r._terms.erase(fixed, r._terms.end());
+
+			if (r._lower > r._upper + scaled(r._upper))
+				throw presolve::infeasible_model("Row bounds cross");
+
+			if (r._terms.empty())
+			{
+				if (r._lower > tolerance || r._upper < -tolerance)
+					throw presolve::infeasible_model("Empty row with nonzero right hand side");
+				remove_row(r);
+				return true;
+			}
+
+			if (r._terms.size() == 1)
+			{
+				auto[j, a] = r._terms.front();
+				double lower = (a > 0 ? r._lower : r._upper) / a;
+				double upper = (a > 0 ? r._upper : r._lower) / a;
+				if (std::isfinite(lower))
+					tighten_lower(j, lower);
+				if (std::isfinite(upper))
+					tighten_upper(j, upper);
+				remove_row(r);
+				return true;
+			}
+
+			return changed;
+		}
+
+		// Rows that are scalar multiples of an earlier row are merged into it
+		bool remove_duplicate_rows()
+		{
+			bool changed = false;
+			std::map<std::vector<std::pair<size_t, double>>, size_t> patterns;
+			for (size_t i = 0; i < _rows.size(); ++i)
+			{
+				row& r = _rows[i];
+				if (!r._active)
+					continue;
+
+				double scale = r._terms.front().second;
+				std::vector<std::pair<size_t, double>> pattern(r._terms);
+				for (auto&term : pattern)
+					term.second /= scale;
+
+				auto[it, inserted] = patterns.emplace(std::move(pattern), i);
+				if (inserted)
+					continue;
+
+				row& original = _rows[it->second];
+				double ratio = scale / original._terms.front().second;
+				double lower = (ratio > 0 ? r._lower : r._upper) / ratio;
+				double upper = (ratio > 0 ? r._upper : r._lower) / ratio;
+				original._lower = std::max(original._lower, lower);
+				original._upper = std::min(original._upper, upper);
+				remove_row(r);
+				changed = true;
+			}
+			return changed;
+		}
+
+		// Activity based bound tightening; rows implied by the column bounds are dropped
+		bool tighten_bounds()
+		{
+			bool changed = false;
+			for (auto&r : _rows)
+			{
+				if (!r._active)
+					continue;
+
+				double min_activity = 0, max_activity = 0;
+				size_t min_infinite = 0, max_infinite = 0;
+				for (const auto&[j, a] : r._terms)
+				{
+					double low = a > 0 ? a * _lower[j] : a * _upper[j];
+					double high = a > 0 ? a * _upper[j] : a * _lower[j];
+					if (std::isfinite(low)) min_activity += low; else ++min_infinite;
+					if (std::isfinite(high)) max_activity += high; else ++max_infinite;
+				}
+
+				if (min_infinite == 0 && max_infinite == 0 &&
+					min_activity >= r._lower - tolerance && max_activity <= r._upper + tolerance)
+				{
+					remove_row(r);
+					changed = true;
+					continue;
+				}
+
+				for (const auto&[j, a] : r._terms)
+				{
+					double low = a > 0 ? a * _lower[j] : a * _upper[j];
+					double high = a > 0 ? a * _upper[j] : a * _lower[j];
+
+					// activity of the other terms of the row
+					double others_min = (min_infinite == 0) ? min_activity - low :
+						(min_infinite == 1 && !std::isfinite(low)) ? min_activity : -infinity;
+					double others_max = (max_infinite == 0) ? max_activity - high :
+						(max_infinite == 1 && !std::isfinite(high)) ? max_activity : infinity;
+
+					if (std::isfinite(r._upper) && std::isfinite(others_min))
+					{
+						double limit = (r._upper - others_min) / a;
+						changed |= a > 0 ? tighten_upper(j, limit) : tighten_lower(j, limit);
+					}
+					if (std::isfinite(r._lower) && std::isfinite(others_max))
+					{
+						double limit = (r._lower - others_max) / a;
+						changed |= a > 0 ? tighten_lower(j, limit) : tighten_upper(j, limit);
+					}
+				}
+			}
+			return changed;
+		}
+
+	public:
+		presolver(const model& m, std::vector<row>& rows, size_t variable_count) :
+			_model(m), _rows(rows), _lower(variable_count, -infinity), _upper(variable_count, infinity), _integer(variable_count)
+		{
+			for (size_t j = 0; j < variable_count; ++j)
+			{
+				_integer[j] = m.is_integer(j);
+				if (m.has_lower_bound(j))
+					_lower[j] = _integer[j] ? std::ceil(m.get_lower_bound(j) - tolerance) : m.get_lower_bound(j);
+				if (m.has_upper_bound(j))
+					_upper[j] = _integer[j] ? std::floor(m.get_upper_bound(j) + tolerance) : m.get_upper_bound(j);
+				check_column(j);
+			}
+		}
+
+		void run()
+		{
+			const int max_tightening_passes = 8;
+			int tightening_passes = 0;
+
+			bool changed = true;
+			while (changed)
+			{
+				changed = false;
+				for (auto&r : _rows)
+				{
+					if (r._active)
+						changed |= reduce_row(r);
+				}
+				changed |= remove_duplicate_rows();
+				if (!changed && tightening_passes++ < max_tightening_passes)
+					changed = tighten_bounds();
+			}
+		}
+
+		// Columns that no longer appear in any row are fixed at their cheapest bound
+		void fix_empty_columns(const std::vector<double>& objective, bool minimize)
+		{
+			std::vector<bool> used(_lower.size());
+			for (const auto&r : _rows)
+			{
+				if (!r._active)
+					continue;
+				for (const auto&term : r._terms)
+					used[term.first] = true;
+			}
+
+			for (size_t j = 0; j < used.size(); ++j)
+			{
+				if (used[j] || is_fixed(j))
+					continue;
+				double cost = minimize ? objective[j] : -objective[j];
+				double value = cost > 0 ? _lower[j] : cost < 0 ? _upper[j] :
+					std::isfinite(_lower[j]) ? _lower[j] : std::isfinite(_upper[j]) ? _upper[j] : 0;
+				if (!std::isfinite(value))
+					continue; // unbounded, leave it to the backend to report
+				_lower[j] = _upper[j] = value;
+			}
+		}
+
+		presolve::postsolve_map make_postsolve_map()
+		{
+			presolve::postsolve_map result(_lower.size());
+			for (size_t j = 0; j < _lower.size(); ++j)
+			{
+				if (is_fixed(j))
+				{
+					result.remove(j, _lower[j]);
+					++_statistics._columns_removed;
+				}
+				else
+				{
+					result.keep(j, _lower[j], _upper[j]);
+				}
+			}
+			return result;
+		}
+
+		const presolve::statistics& statistics() const { return _statistics; }
+	};
+}
+
+presolve::statistics model::presolve()
+{
+	if (_postsolve.active())
+		throw std::logic_error("Model already presolved");
+	if (has_streamed_rows())
+		throw std::logic_error("Cannot presolve a model whose rows were streamed to a backend");
+	if (has_semicontinuous() || has_sos())
+		throw std::logic_error("Cannot presolve a model with semi-continuous variables or SOS sets");
+
+	stopwatch watch(_presolve_timing);
+	memory::resource_scope resource(memory::arenas_enabled() ? _arena.resource() : nullptr);
+	size_t count = variable_count();
+
+	std::vector<row> rows;
+	rows.reserve(_constraints.size());
+	for (const auto&c : _constraints)
+		rows.push_back(make_row(c));
+
+	std::map<size_t, double> objective_terms;
+	double objective_constant = 0;
+	collect_terms(_objective, objective_terms, objective_constant);
+	std::vector<double> objective(count);
+	for (const auto&term : objective_terms)
+		objective[term.first] = term.second;
+
+	presolver p(*this, rows, count);
+	p.run();
+	p.fix_empty_columns(objective, _minimize);
+	presolve::postsolve_map postsolve = p.make_postsolve_map();
+
+	// Rewrite rows and objective over the remaining columns
+	std::vector<constraint> constraints;
+	for (auto&r : rows)
+	{
+		if (!r._active)
+			continue;
+
+		double shift = 0;
+		std::vector<std::pair<size_t, double>> terms;
+		for (const auto&[j, a] : r._terms)
+		{
+			if (postsolve.is_removed(j))
+				shift += a * postsolve.removed_value(j);
+			else
+				terms.emplace_back(postsolve.column_index(j), a);
+		}
+
+		constraint c;
+		c._expression = make_sum(terms, 0);
+		if (std::isfinite(r._lower))
+			c._lower_bound = r._lower - shift;
+		if (std::isfinite(r._upper))
+			c._upper_bound = r._upper - shift;
+		constraints.push_back(std::move(c));
+	}
+
+	std::vector<std::pair<size_t, double>> objective_columns;
+	for (const auto&[j, a] : objective_terms)
+	{
+		if (postsolve.is_removed(j))
+			objective_constant += a * postsolve.removed_value(j);
+		else if (a != 0)
+			objective_columns.emplace_back(postsolve.column_index(j), a);
+	}
+
+	// The remaining rows were built from the model arena; the family arenas can go
+	_constraints = std::move(constraints);
+	_families.clear();
+	_objective = make_sum(objective_columns, objective_constant);
+	_postsolve = std::move(postsolve);
+
+	return p.statistics();
+}
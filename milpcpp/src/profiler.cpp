@@ -0,0 +1,295 @@
+#include<milpcpp/profiler.h>
+
+#include<atomic>
+#include<cstdlib>
+#include<new>
+#include<thread>
+
+using namespace milpcpp::profiling;
+
+namespace
+{
+	thread_local family_statistics * current_family = nullptr;
+	thread_local scope * current_scope = nullptr;
+	thread_local size_t thread_allocated_bytes = 0;
+
+	size_t thread_index()
+	{
+		static std::atomic<size_t> thread_count{ 0 };
+		thread_local size_t index = ++thread_count;
+		return index;
+	}
+
+	double seconds(clock::duration d)
+	{
+		return std::chrono::duration<double>(d).count();
+	}
+
+	double microseconds(clock::duration d)
+	{
+		return std::chrono::duration<double, std::micro>(d).count();
+	}
+
+	const char * kind_name(family_kind kind)
+	{
+		switch (kind)
+		{
+		case family_kind::constraints: return "constraints";
+		case family_kind::objective: return "objective";
+		case family_kind::backend: return "backend";
+		default: return "unattributed";
+		}
+	}
+
+	std::string escape_json(const std::string& s)
+	{
+		std::string result;
+		for (char c : s)
+		{
+			if (c == '"' || c == '\\')
+				result += '\\';
+			result += c;
+		}
+		return result;
+	}
+
+	std::string escape_csv(const std::string& s)
+	{
+		std::string result = "\"";
+		for (char c : s)
+		{
+			if (c == '"')
+				result += '"';
+			result += c;
+		}
+		return result + "\"";
+	}
+
+	void write_json_family(std::ostream& out, const family_statistics& f)
+	{
+		out << "{\"name\": \"" << escape_json(f._name) << "\""
+			<< ", \"kind\": \"" << kind_name(f._kind) << "\""
+			<< ", \"rows\": " << f._rows
+			<< ", \"nonzeros\": " << f._nonzeros
+			<< ", \"total_time\": " << f._total_time
+			<< ", \"lambda_time\": " << f.time(category::lambda)
+			<< ", \"arithmetic_time\": " << f.time(category::arithmetic)
+			<< ", \"container_time\": " << f.time(category::container)
+			<< ", \"load_time\": " << f.time(category::load)
+			<< ", \"solve_time\": " << f.time(category::solve)
+			<< ", \"bytes_allocated\": " << f._bytes_allocated << "}";
+	}
+
+	void write_csv_family(std::ostream& out, const family_statistics& f)
+	{
+		out << escape_csv(f._name) << ',' << kind_name(f._kind) << ','
+			<< f._rows << ',' << f._nonzeros << ',' << f._total_time << ','
+			<< f.time(category::lambda) << ',' << f.time(category::arithmetic) << ','
+			<< f.time(category::container) << ',' << f.time(category::load) << ','
+			<< f.time(category::solve) << ',' << f._bytes_allocated << '\n';
+	}
+}
+
+#ifdef MILPCPP_COUNT_ALLOCATIONS
+
+void * operator new(size_t size)
+{
+	thread_allocated_bytes += size;
+	if (void * p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void * p, size_t) noexcept
+{
+	std::free(p);
+}
+
+#endif
+
+namespace milpcpp
+{
+	namespace profiling
+	{
+		profiler * profiler::_context = nullptr;
+		thread_local profiler::thread_statistics * profiler::_thread_unattributed = nullptr;
+		thread_local size_t profiler::_thread_owner = 0;
+
+		profiler::profiler()
+		{
+			static std::atomic<size_t> profiler_count{ 0 };
+			_id = ++profiler_count;
+			_context = this;
+		}
+
+		// Only the first scope of a thread outside any family takes the lock
+		profiler::thread_statistics& profiler::unattributed()
+		{
+			if (_thread_owner != _id)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_unattributed.push_back(thread_statistics{ family_statistics{}, allocated_bytes() });
+				_thread_unattributed = &_unattributed.back();
+				_thread_owner = _id;
+			}
+			return *_thread_unattributed;
+		}
+
+		// Read when the threads building the model are done with it
+		family_statistics profiler::merged_unattributed() const
+		{
+			family_statistics result;
+			for (const auto& t : _unattributed)
+			{
+				for (size_t c = 0; c < result._times.size(); ++c)
+					result._times[c] += t._statistics._times[c];
+			}
+			return result;
+		}
+
+		size_t allocated_bytes()
+		{
+			return thread_allocated_bytes;
+		}
+
+		// The objective is built on the thread calling maximize()/minimize(),
+		// so only that thread's unattributed work is credited to it
+		void profiler::add_objective(const std::string& name, size_t nonzeros)
+		{
+			thread_statistics& t = unattributed();
+			std::lock_guard<std::mutex> lock(_mutex);
+			family_statistics objective = t._statistics;
+			objective._name = name;
+			objective._kind = family_kind::objective;
+			objective._rows = 1;
+			objective._nonzeros = nonzeros;
+			objective._bytes_allocated = allocated_bytes() - t._start_bytes;
+			for (double time : objective._times)
+				objective._total_time += time;
+			_families.push_back(objective);
+			t._statistics = family_statistics{};
+			t._start_bytes = allocated_bytes();
+
+			if (_trace)
+			{
+				double end = microseconds(clock::now() - _start);
+				double duration = objective._total_time * 1e6;
+				_events.push_back(trace_event{ name, family_kind::objective, end - duration, duration,
+					thread_index() });
+			}
+		}
+
+		void profiler::write_json(std::ostream& out) const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			out << "{\n\"families\": [";
+			const char * separator = "\n";
+			for (const auto&f : _families)
+			{
+				out << separator;
+				write_json_family(out, f);
+				separator = ",\n";
+			}
+			out << "\n],\n\"unattributed\": ";
+			write_json_family(out, merged_unattributed());
+			out << "\n}\n";
+		}
+
+		void profiler::write_csv(std::ostream& out) const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			out << "name,kind,rows,nonzeros,total_time,lambda_time,arithmetic_time,"
+				"container_time,load_time,solve_time,bytes_allocated\n";
+			for (const auto&f : _families)
+				write_csv_family(out, f);
+			write_csv_family(out, merged_unattributed());
+		}
+
+		void profiler::write_chrome_trace(std::ostream& out) const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			out << "{\"traceEvents\": [";
+			const char * separator = "\n";
+			for (const auto&e : _events)
+			{
+				out << separator << "{\"name\": \"" << escape_json(e._name) << "\""
+					<< ", \"cat\": \"" << kind_name(e._kind) << "\""
+					<< ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e._thread
+					<< ", \"ts\": " << e._start << ", \"dur\": " << e._duration << "}";
+				separator = ",\n";
+			}
+			out << "\n]}\n";
+		}
+
+		family_scope::family_scope(const std::string& name, family_kind kind) :
+			_profiler(profiler::current()), _family(nullptr)
+		{
+			if (!_profiler)
+				return;
+
+			{
+				std::lock_guard<std::mutex> lock(_profiler->_mutex);
+				_profiler->_families.push_back(family_statistics{ name, kind });
+				_family = &_profiler->_families.back();
+			}
+			_previous = current_family;
+			_previous_scope = current_scope;
+			current_family = _family;
+			current_scope = nullptr;
+			_start_bytes = allocated_bytes();
+			_start = clock::now();
+		}
+
+		family_scope::~family_scope()
+		{
+			if (!_family)
+				return;
+
+			auto end = clock::now();
+			_family->_total_time = seconds(end - _start);
+			_family->_bytes_allocated = allocated_bytes() - _start_bytes;
+			current_family = _previous;
+			current_scope = _previous_scope;
+
+			if (_profiler->_trace)
+			{
+				std::lock_guard<std::mutex> lock(_profiler->_mutex);
+				_profiler->_events.push_back(trace_event{ _family->_name, _family->_kind,
+					microseconds(_start - _profiler->_start), microseconds(end - _start),
+					thread_index() });
+			}
+		}
+
+		void family_scope::add_rows(size_t rows, size_t nonzeros)
+		{
+			if (!_family)
+				return;
+			_family->_rows += rows;
+			_family->_nonzeros += nonzeros;
+		}
+
+		// Both a family's statistics and the unattributed ones belong to the
+		// calling thread, so a scope takes no lock
+		void scope::begin()
+		{
+			_family = current_family ? current_family : &profiler::current()->unattributed()._statistics;
+			_parent = current_scope;
+			current_scope = this;
+			_start = clock::now();
+		}
+
+		void scope::end()
+		{
+			double elapsed = seconds(clock::now() - _start);
+			_family->_times[(size_t)_category] += elapsed - _child_time;
+			if (_parent)
+				_parent->_child_time += elapsed;
+			current_scope = _parent;
+		}
+	}
+}
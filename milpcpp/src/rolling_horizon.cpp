@@ -0,0 +1,211 @@
+#include<milpcpp/rolling_horizon.h>
+
+#include<algorithm>
+#include<cmath>
+#include<stdexcept>
+
+using namespace milpcpp;
+
+namespace milpcpp
+{
+	// Columns of committed periods keep their values and later ones go to
+	// their bound nearest to zero; changed lists the columns whose bounds in
+	// m this moves
+	void rolling_horizon::set_bounds(const matrix& full, matrix& m, long first, long last, std::vector<int>& changed)
+	{
+		changed.clear();
+		for (size_t j = 0; j < full._columns; ++j)
+		{
+			long p = _column_period[j];
+			double lower = full._column_lower[j], upper = full._column_upper[j];
+			if (p != no_period && p < first)
+				lower = upper = _committed[_model->original_index(j)];
+			else if (p != no_period && p > last)
+				lower = upper = std::min(std::max(0.0, lower), upper);
+			if (lower == m._column_lower[j] && upper == m._column_upper[j])
+				continue;
+			m._column_lower[j] = lower;
+			m._column_upper[j] = upper;
+			changed.push_back((int)j);
+		}
+	}
+
+	// Appends the rows of full using no column after last that m does not
+	// have yet; the next window only frees columns, so no row leaves again
+	void rolling_horizon::add_rows(const matrix& full, matrix& m, long last)
+	{
+		for (size_t i = 0; i < full.row_count(); ++i)
+		{
+			if (_in_window[i])
+				continue;
+			int begin = full._row_starts[i], end = full._row_starts[i + 1];
+			bool keep = true;
+			for (int k = begin; k < end && keep; ++k)
+			{
+				long p = _column_period[full._row_indices[k]];
+				keep = p == no_period || p <= last;
+			}
+			if (!keep)
+				continue;
+			m._row_indices.insert(m._row_indices.end(), full._row_indices.begin() + begin, full._row_indices.begin() + end);
+			m._row_values.insert(m._row_values.end(), full._row_values.begin() + begin, full._row_values.begin() + end);
+			m._row_starts.push_back((int)m._row_indices.size());
+			m._row_lower.push_back(full._row_lower[i]);
+			m._row_upper.push_back(full._row_upper[i]);
+			_in_window[i] = 1;
+			_kept_rows.push_back((int)i);
+		}
+	}
+
+	// The last window's basis on this window's rows. Rows new to the window
+	// enter with their slack basic; columns fixed since then leave the
+	// basis, and slacks enter or leave, until as many are basic as there
+	// are rows.
+	void rolling_horizon::warm_start(const matrix& m)
+	{
+		if (_column_basis.size() != m._columns)
+			return;
+		std::vector<basis_status> rows(_kept_rows.size()), columns = _column_basis;
+		for (size_t i = 0; i < rows.size(); ++i)
+			rows[i] = _row_basis[_kept_rows[i]];
+
+		size_t basic = std::count(rows.begin(), rows.end(), basis_status::basic) +
+			std::count(columns.begin(), columns.end(), basis_status::basic);
+		for (size_t j = 0; j < columns.size() && basic > rows.size(); ++j)
+		{
+			if (columns[j] == basis_status::basic && m._column_lower[j] == m._column_upper[j])
+			{
+				columns[j] = basis_status::fixed;
+				--basic;
+			}
+		}
+		for (size_t i = 0; i < rows.size() && basic != rows.size(); ++i)
+		{
+			if ((rows[i] == basis_status::basic) == (basic < rows.size()))
+				continue;
+			if (basic < rows.size())
+			{
+				rows[i] = basis_status::basic;
+				++basic;
+			}
+			else
+			{
+				rows[i] = std::isfinite(m._row_lower[i]) ? basis_status::lower :
+					std::isfinite(m._row_upper[i]) ? basis_status::upper : basis_status::free;
+				--basic;
+			}
+		}
+		_backend->set_warm_start(std::move(rows), std::move(columns));
+	}
+
+	rolling_horizon_report rolling_horizon::solve()
+	{
+		if (_options._window == 0 || _options._overlap >= _options._window)
+			throw std::invalid_argument("A rolling horizon window needs more periods than it overlaps");
+		long first = no_period, last = no_period;
+		for (long p : _period)
+		{
+			if (p == no_period)
+				continue;
+			first = first == no_period ? p : std::min(first, p);
+			last = std::max(last, p);
+		}
+		if (first == no_period)
+			throw std::logic_error("A rolling horizon needs variables with a period");
+
+		rolling_horizon_report report;
+		if (_options._monolithic)
+			report._monolithic = _backend->solve();
+
+		// The whole horizon; each window takes its columns and a part of its rows
+		matrix full;
+		_model->load_matrix(full, false);
+		std::vector<double> no_start;
+		full.linearize(true, true, no_start);
+		_column_period.assign(full._columns, no_period);
+		for (size_t j = 0; j < _model->column_count(); ++j)
+		{
+			size_t absolute_index = _model->original_index(j);
+			if (absolute_index < _period.size())
+				_column_period[j] = _period[absolute_index];
+		}
+		matrix window = full;
+		window.clear_rows();
+
+		_committed.assign(_period.size(), 0);
+		_in_window.assign(full.row_count(), 0);
+		_kept_rows.clear();
+		_row_basis.assign(full.row_count(), basis_status::basic);
+		_column_basis.clear();
+		std::vector<int> changed;
+		size_t loaded_rows = 0;
+		long step = (long)(_options._window - _options._overlap);
+		for (long start = first;; start += step)
+		{
+			long end = start + (long)_options._window - 1;
+			set_bounds(full, window, start, end, changed);
+			add_rows(full, window, end);
+
+			// Without a warm start every window is loaded afresh
+			if (loaded_rows != 0 && !(_options._warm_start && _backend->update_column_bounds(window, changed)))
+				loaded_rows = 0;
+			if (loaded_rows == 0 && _options._warm_start)
+				warm_start(window);
+
+			solve_result result = _backend->solve(window, loaded_rows);
+			loaded_rows = window.row_count();
+			report._windows.push_back(result);
+			report._status = result._status;
+			add_timing(report._total, result._load);
+			add_timing(report._total, result._solve);
+			if (!result.has_solution())
+				break;
+			if (end >= last)
+			{
+				report._objective = result._objective;
+				break;
+			}
+
+			for (size_t i = 0; i < _period.size(); ++i)
+			{
+				if (_period[i] != no_period && _period[i] < start + step)
+					_committed[i] = _backend->get_variable_value(i);
+			}
+			if (_options._warm_start)
+			{
+				std::vector<basis_status> rows;
+				_backend->get_final_basis(rows, _column_basis);
+				if (rows.size() == _kept_rows.size())
+				{
+					for (size_t i = 0; i < rows.size(); ++i)
+						_row_basis[_kept_rows[i]] = rows[i];
+				}
+				else
+					_column_basis.clear();
+			}
+		}
+		return report;
+	}
+
+	void rolling_horizon_report::write_json(std::ostream& out) const
+	{
+		out << "{\"status\": \"" << status_name(_status) << "\"";
+		if (_objective.has_value())
+			out << ", \"objective\": " << _objective.value();
+		out << ", \"total_wall_time\": " << _total._wall << ", \"total_cpu_time\": " << _total._cpu
+			<< ", \"windows\": [";
+		for (size_t w = 0; w < _windows.size(); ++w)
+		{
+			if (w != 0)
+				out << ", ";
+			_windows[w].write_json(out);
+		}
+		out << "]";
+		if (_monolithic.has_value())
+		{
+			out << ", \"monolithic\": ";
+			_monolithic->write_json(out);
+		}
+		out << "}";
+	}
+}
@@ -0,0 +1,204 @@
+#include<milpcpp/solution_cache.h>
+
+#include<algorithm>
+#include<chrono>
+#include<cstdio>
+#include<filesystem>
+#include<fstream>
+#include<sstream>
+#include<thread>
+
+using namespace milpcpp;
+
+namespace
+{
+	const char magic[8] = { 'M', 'I', 'L', 'P', 'C', 'P', 'P', 1 };
+
+	template<typename T>
+	void write_value(std::ostream& out, const T& value)
+	{
+		out.write((const char*)&value, sizeof(T));
+	}
+
+	template<typename T>
+	bool read_value(std::istream& in, T& value)
+	{
+		return (bool)in.read((char*)&value, sizeof(T));
+	}
+
+	template<typename T>
+	void write_vector(std::ostream& out, const std::vector<T>& values)
+	{
+		write_value(out, (uint64_t)values.size());
+		out.write((const char*)values.data(), values.size() * sizeof(T));
+	}
+
+	// The count is checked against the bytes left before end, so that a
+	// truncated or corrupt file cannot ask for a huge allocation
+	template<typename T>
+	bool read_vector(std::istream& in, std::vector<T>& values, uint64_t end)
+	{
+		uint64_t size;
+		if (!read_value(in, size))
+			return false;
+		std::streamoff position = in.tellg();
+		if (position < 0 || (uint64_t)position > end || size > (end - (uint64_t)position) / sizeof(T))
+			return false;
+		values.resize((size_t)size);
+		return (bool)in.read((char*)values.data(), values.size() * sizeof(T));
+	}
+}
+
+namespace milpcpp
+{
+	void lru_cache::insert(const fingerprint& key, const cached_solution& solution)
+	{
+		auto found = _index.find(key);
+		if (found != _index.end())
+		{
+			found->second->second = solution;
+			_entries.splice(_entries.begin(), _entries, found->second);
+			return;
+		}
+		_entries.emplace_front(key, solution);
+		_index[key] = _entries.begin();
+		while (_entries.size() > _capacity)
+		{
+			_index.erase(_entries.back().first);
+			_entries.pop_back();
+		}
+	}
+
+	bool lru_cache::find(const fingerprint& key, cached_solution& solution)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto found = _index.find(key);
+			if (found != _index.end())
+			{
+				_entries.splice(_entries.begin(), _entries, found->second);
+				solution = found->second->second;
+				return true;
+			}
+		}
+		if (!_next || !_next->find(key, solution))
+			return false;
+		std::lock_guard<std::mutex> lock(_mutex);
+		insert(key, solution);
+		return true;
+	}
+
+	void lru_cache::store(const fingerprint& key, const cached_solution& solution)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			insert(key, solution);
+		}
+		if (_next)
+			_next->store(key, solution);
+	}
+
+	size_t lru_cache::size() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _entries.size();
+	}
+
+	void lru_cache::clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_index.clear();
+		_entries.clear();
+	}
+
+	disk_cache::disk_cache(const std::string& directory) : _directory(directory)
+	{
+		std::filesystem::create_directories(_directory);
+	}
+
+	std::string disk_cache::path(const fingerprint& key) const
+	{
+		return (std::filesystem::path(_directory) / (key.to_string() + ".solution")).string();
+	}
+
+	bool disk_cache::find(const fingerprint& key, cached_solution& solution)
+	{
+		std::ifstream in(path(key), std::ios::binary);
+		if (!in || !in.seekg(0, std::ios::end))
+			return false;
+		std::streamoff length = in.tellg();
+		if (length < 0 || !in.seekg(0, std::ios::beg))
+			return false;
+		uint64_t end = (uint64_t)length;
+
+		char header[sizeof(magic)];
+		if (!in.read(header, sizeof(header)) || !std::equal(header, header + sizeof(header), magic))
+			return false;
+
+		cached_solution read;
+		int32_t status, code;
+		uint8_t has_objective;
+		double objective;
+		uint64_t iterations, nodes;
+		if (!read_value(in, status) || !read_value(in, code) || !read_value(in, has_objective) ||
+			!read_value(in, objective) || !read_value(in, iterations) || !read_value(in, nodes) ||
+			!read_vector(in, read._values, end) || !read_vector(in, read._row_basis, end) || !read_vector(in, read._column_basis, end))
+			return false;
+		read._result._status = (solve_status)status;
+		read._result._backend_code = code;
+		if (has_objective)
+			read._result._objective = objective;
+		read._result._iterations = (size_t)iterations;
+		read._result._nodes = (size_t)nodes;
+		solution = std::move(read);
+		return true;
+	}
+
+	void disk_cache::store(const fingerprint& key, const cached_solution& solution)
+	{
+		std::ostringstream suffix;
+		suffix << ".tmp" << std::this_thread::get_id() << '.' << std::chrono::steady_clock::now().time_since_epoch().count();
+		std::string target = path(key);
+		std::string temporary = target + suffix.str();
+		{
+			std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+			if (!out)
+				return;
+			const auto& r = solution._result;
+			out.write(magic, sizeof(magic));
+			write_value(out, (int32_t)r._status);
+			write_value(out, (int32_t)r._backend_code);
+			write_value(out, (uint8_t)r._objective.has_value());
+			write_value(out, r._objective.value_or(0));
+			write_value(out, (uint64_t)r._iterations);
+			write_value(out, (uint64_t)r._nodes);
+			write_vector(out, solution._values);
+			write_vector(out, solution._row_basis);
+			write_vector(out, solution._column_basis);
+			if (!out)
+			{
+				out.close();
+				std::remove(temporary.c_str());
+				return;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(temporary, target, error);
+		if (error)
+			std::remove(temporary.c_str());
+	}
+
+	bool find_solution(solution_cache& cache, const fingerprint& key, cached_solution& solution, solve_result& result)
+	{
+		if (!cache.find(key, solution))
+			return false;
+		solve_result hit = solution._result;
+		hit._cache_hit = true;
+		hit._presolve = result._presolve;
+		hit._fingerprint = result._fingerprint;
+		hit._load = timing();
+		hit._solve = timing();
+		result = hit;
+		return true;
+	}
+}
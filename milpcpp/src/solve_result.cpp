@@ -0,0 +1,94 @@
+#include<milpcpp/solve_result.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include<windows.h>
+#else
+#include<time.h>
+#endif
+
+using namespace milpcpp;
+
+namespace
+{
+	void write_timing(std::ostream& out, const char * name, const timing& t)
+	{
+		out << ", \"" << name << "_wall_time\": " << t._wall << ", \"" << name << "_cpu_time\": " << t._cpu;
+	}
+}
+
+namespace milpcpp
+{
+	const char * status_name(solve_status status)
+	{
+		switch (status)
+		{
+		case solve_status::optimal: return "optimal";
+		case solve_status::feasible: return "feasible";
+		case solve_status::infeasible: return "infeasible";
+		case solve_status::unbounded: return "unbounded";
+		case solve_status::infeasible_or_unbounded: return "infeasible_or_unbounded";
+		case solve_status::time_limit: return "time_limit";
+		case solve_status::iteration_limit: return "iteration_limit";
+		case solve_status::cancelled: return "cancelled";
+		case solve_status::failed: return "failed";
+		default: return "not_solved";
+		}
+	}
+
+	double thread_cpu_time()
+	{
+#ifdef _WIN32
+		FILETIME creation, exit, kernel, user;
+		if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+			return 0;
+		auto ticks = [](const FILETIME& t) { return (double)(((unsigned long long)t.dwHighDateTime << 32) | t.dwLowDateTime); };
+		return (ticks(kernel) + ticks(user)) * 1e-7;	// 100 ns units
+#else
+		timespec t;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) != 0)
+			return 0;
+		return t.tv_sec + t.tv_nsec * 1e-9;
+#endif
+	}
+
+	void solve_result::write_json(std::ostream& out) const
+	{
+		out << "{\"status\": \"" << status_name(_status) << "\"";
+		if (_objective.has_value())
+			out << ", \"objective\": " << _objective.value();
+		out << ", \"iterations\": " << _iterations
+			<< ", \"nodes\": " << _nodes
+			<< ", \"backend_code\": " << _backend_code
+			<< ", \"cache_hit\": " << (_cache_hit ? "true" : "false");
+		if (_start_accepted.has_value())
+			out << ", \"start_accepted\": " << (_start_accepted.value() ? "true" : "false");
+		write_timing(out, "presolve", _presolve);
+		write_timing(out, "fingerprint", _fingerprint);
+		write_timing(out, "load", _load);
+		write_timing(out, "solve", _solve);
+		out << "}";
+	}
+
+	void solve_result::write_csv_header(std::ostream& out)
+	{
+		out << "status,objective,iterations,nodes,backend_code,cache_hit,start_accepted,"
+			"presolve_wall_time,presolve_cpu_time,fingerprint_wall_time,fingerprint_cpu_time,load_wall_time,load_cpu_time,solve_wall_time,solve_cpu_time\n";
+	}
+
+	void solve_result::write_csv(std::ostream& out) const
+	{
+		out << status_name(_status) << ',';
+		if (_objective.has_value())
+			out << _objective.value();
+		out << ',' << _iterations << ',' << _nodes << ',' << _backend_code << ',' << _cache_hit << ',';
+		if (_start_accepted.has_value())
+			out << _start_accepted.value();
+		out << ','
+			<< _presolve._wall << ',' << _presolve._cpu << ','
+			<< _fingerprint._wall << ',' << _fingerprint._cpu << ','
+			<< _load._wall << ',' << _load._cpu << ','
+			<< _solve._wall << ',' << _solve._cpu << '\n';
+	}
+}
@@ -0,0 +1,54 @@
+#ifndef __MILPCPP_SOLVER_SUPPORT_H__
+#define __MILPCPP_SOLVER_SUPPORT_H__
+
+#include<algorithm>
+#include<array>
+#include<vector>
+
+#include<milpcpp/matrix.h>
+#include<milpcpp/solution_cache.h>
+
+namespace milpcpp
+{
+	// What the backends of the solver libraries share; not installed
+	namespace solver_support
+	{
+		// The bounds in v from first on, with the solver's infinity
+		inline std::vector<double> solver_bounds(const std::vector<double>& v, size_t first, double infinity)
+		{
+			std::vector<double> b(v.begin() + first, v.end());
+			for (double& x : b)
+			{
+				if (x == matrix::infinity)
+					x = infinity;
+				else if (x == -matrix::infinity)
+					x = -infinity;
+			}
+			return b;
+		}
+
+		// A solver's statuses for basic, lower, upper, free and fixed, in the
+		// order of basis_status
+		typedef std::array<int, 5> basis_codes;
+
+		inline std::vector<int> to_solver_basis(const std::vector<basis_status>& basis, const basis_codes& codes)
+		{
+			std::vector<int> statuses(basis.size());
+			std::transform(basis.begin(), basis.end(), statuses.begin(), [&](basis_status s) { return codes[(size_t)s]; });
+			return statuses;
+		}
+
+		// The first status with the solver's code, or otherwise
+		inline std::vector<basis_status> from_solver_basis(const std::vector<int>& statuses, const basis_codes& codes, basis_status otherwise)
+		{
+			std::vector<basis_status> basis(statuses.size());
+			std::transform(statuses.begin(), statuses.end(), basis.begin(), [&](int code) {
+				auto it = std::find(codes.begin(), codes.end(), code);
+				return it == codes.end() ? otherwise : (basis_status)(it - codes.begin());
+			});
+			return basis;
+		}
+	}
+}
+
+#endif